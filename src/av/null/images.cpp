@@ -32,15 +32,24 @@ TiledImageID Images::loadTiles(StringView path,
                                int tileHeight) noexcept {
     return TiledImageID(0);
 }
+void Images::invalidate(StringView path) noexcept {}
 void Images::prune(time_t latestPermissibleUse) noexcept {}
+ImageID Images::makeCanvas(int width, int height) noexcept {
+    return ImageID(0);
+}
 
 int TiledImage::size(TiledImageID tiid) noexcept { return 1000; }
 ImageID TiledImage::getTile(TiledImageID tiid, int i) noexcept {
     return ImageID(0);
 }
+void TiledImage::resetTile(TiledImageID tiid, int i, ImageID tile) noexcept {}
 void TiledImage::release(TiledImageID tiid) noexcept {}
 
 void Image::draw(ImageID iid, float x, float y, float z) noexcept {}
+void Image::drawMany(const DisplayItem* items, size_t count) noexcept {}
+void Image::drawOnto(ImageID canvas,
+                     const DisplayItem* items,
+                     size_t count) noexcept {}
 int Image::width(ImageID iid) noexcept { return 1; }
 int Image::height(ImageID iid) noexcept { return 1; }
 void Image::release(ImageID iid) noexcept {}
@@ -31,6 +31,7 @@
 #include "util/string-view.h"
 
 SoundID Sounds::load(StringView path) noexcept { return mark; }
+void Sounds::invalidate(StringView path) noexcept {}
 void Sounds::prune(time_t latestPermissibleUse) noexcept {}
 
 PlayingSoundID Sound::play(SoundID id) noexcept { return mark; }
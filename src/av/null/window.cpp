@@ -113,6 +113,17 @@ GameWindow::mainLoop() noexcept {
             sleepDuration = 0;
         }
 
+        // If nothing can change for longer than a frame, sleep until then.
+        time_t idle = World::timeUntilWakeup();
+        if (ms_to_ns(idle) > sleepDuration) {
+            SleepFor(ms_to_ns(idle));
+
+            previousFrameStart = frameStart;
+            frameStart = SteadyClock::now();
+            nextFrameStart = frameStart + idealFrameTime;
+            continue;
+        }
+
         if (sleepDuration) {
             SleepFor(sleepDuration);
         }
@@ -0,0 +1,279 @@
+/********************************
+** Tsunagari Tile Engine       **
+** atlas.cpp                   **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#include "av/sdl2/atlas.h"
+
+#include "av/sdl2/error.h"
+#include "av/sdl2/window.h"
+#include "core/log.h"
+#include "util/assert.h"
+#include "util/int.h"
+#include "util/string.h"
+#include "util/vector.h"
+
+// Largest page we will create. Clamped to what the renderer supports.
+#define MAX_PAGE_SIZE 2048
+
+// Empty pixels left around each packed image so that sampling at the edge of
+// one image never picks up its neighbor. Each image is followed by a gutter
+// on its right and bottom, and the page's first row and column are left
+// empty, so every image has a gutter on all four sides.
+#define PADDING 1
+
+// A row of images with the height of the tallest image placed in it.
+//
+// Space on a shelf is handed out left to right and is not reused while any
+// image on the shelf is still alive. Once the last one is removed the shelf
+// starts over from the left and can take images of any height up to its own.
+struct Shelf {
+    int y;
+    int height;
+    int width;  // Filled so far, from the left.
+    int numRegions;
+};
+
+struct Page {
+    SDL_Texture* texture;
+    Vector<Shelf> shelves;  // Ordered by y.
+    int height;  // Filled so far, from the top.
+    int numRegions;
+};
+
+static Vector<Page> pages;
+static int pageSize = 0;
+
+static int
+getPageSize() noexcept {
+    if (pageSize) {
+        return pageSize;
+    }
+
+    pageSize = MAX_PAGE_SIZE;
+
+    SDL_RendererInfo info;
+    if (SDL_GetRendererInfo(SDL2GameWindow::renderer, &info) == 0) {
+        // Zero means there is no limit.
+        if (info.max_texture_width && info.max_texture_width < pageSize) {
+            pageSize = info.max_texture_width;
+        }
+        if (info.max_texture_height && info.max_texture_height < pageSize) {
+            pageSize = info.max_texture_height;
+        }
+    }
+
+    return pageSize;
+}
+
+// Finds room for a w by h rectangle in a page, preferring the existing shelf
+// that wastes the least height, then a new shelf below the others.
+static bool
+findSpace(Page& page, int w, int h, int* x, int* y) noexcept {
+    Shelf* best = nullptr;
+    for (Shelf& shelf : page.shelves) {
+        if (h <= shelf.height && shelf.width + w <= pageSize &&
+            (!best || shelf.height < best->height)) {
+            best = &shelf;
+        }
+    }
+
+    if (!best) {
+        if (page.height + h > pageSize) {
+            return false;
+        }
+        page.shelves.push_back(Shelf{page.height, h, PADDING, 0});
+        page.height += h;
+        best = &page.shelves.back();
+    }
+
+    *x = best->width;
+    *y = best->y;
+    best->width += w;
+    best->numRegions += 1;
+    return true;
+}
+
+static Shelf&
+shelfAt(Page& page, int y) noexcept {
+    for (Shelf& shelf : page.shelves) {
+        if (shelf.y == y) {
+            return shelf;
+        }
+    }
+    assert_(false);
+    return page.shelves[0];
+}
+
+static int
+newPage() noexcept {
+    SDL_Texture* texture = SDL_CreateTexture(SDL2GameWindow::renderer,
+                                             SDL_PIXELFORMAT_ARGB8888,
+                                             SDL_TEXTUREACCESS_STATIC,
+                                             pageSize,
+                                             pageSize);
+    if (!texture) {
+        sdlError("Atlas", "SDL_CreateTexture");
+        return -1;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    // A static texture starts out with undefined contents. Clear it so the
+    // gutters between images are transparent.
+    void* zeros = SDL_calloc(static_cast<size_t>(pageSize) * pageSize, 4);
+    if (!zeros) {
+        SDL_DestroyTexture(texture);
+        return -1;
+    }
+    int err = SDL_UpdateTexture(texture, nullptr, zeros, pageSize * 4);
+    SDL_free(zeros);
+    if (err < 0) {
+        sdlError("Atlas", "SDL_UpdateTexture");
+        SDL_DestroyTexture(texture);
+        return -1;
+    }
+
+    // Reuse the slot of a page that has been emptied, if there is one.
+    int p = 0;
+    while (p < static_cast<int>(pages.size()) && pages[p].texture) {
+        p++;
+    }
+    if (p == static_cast<int>(pages.size())) {
+        pages.resize(pages.size() + 1);
+    }
+
+    Page& page = pages[p];
+    page.texture = texture;
+    page.shelves.clear();
+    page.height = PADDING;
+    page.numRegions = 0;
+
+    Log::info("Atlas",
+              String() << "Created page " << p << " at " << pageSize << "x"
+                       << pageSize);
+
+    return p;
+}
+
+static Optional<AtlasRegion>
+addStandalone(SDL_Surface* surface) noexcept {
+    SDL_Texture* texture =
+            SDL_CreateTextureFromSurface(SDL2GameWindow::renderer, surface);
+    if (!texture) {
+        sdlError("Atlas", "SDL_CreateTextureFromSurface");
+        return none;
+    }
+    return Optional<AtlasRegion>(AtlasRegion{texture, -1, 0, 0});
+}
+
+Optional<AtlasRegion>
+atlasAdd(SDL_Surface* surface) noexcept {
+    int size = getPageSize();
+
+    int w = surface->w + PADDING;
+    int h = surface->h + PADDING;
+
+    // Images that would take up most of a page are not worth packing.
+    if (w > size / 2 || h > size / 2) {
+        return addStandalone(surface);
+    }
+
+    int p = -1;
+    int x;
+    int y;
+    for (size_t i = 0; i < pages.size(); i++) {
+        if (pages[i].texture && findSpace(pages[i], w, h, &x, &y)) {
+            p = static_cast<int>(i);
+            break;
+        }
+    }
+    if (p == -1) {
+        p = newPage();
+        if (p == -1) {
+            return addStandalone(surface);
+        }
+        bool found = findSpace(pages[p], w, h, &x, &y);
+        assert_(found);
+        (void)found;
+    }
+
+    Page& page = pages[p];
+    page.numRegions += 1;
+
+    SDL_Surface* converted =
+            SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!converted) {
+        sdlError("Atlas", "SDL_ConvertSurfaceFormat");
+        atlasRemove(AtlasRegion{page.texture, p, x, y});
+        return none;
+    }
+
+    SDL_Rect rect{x, y, surface->w, surface->h};
+    int err = SDL_UpdateTexture(
+            page.texture, &rect, converted->pixels, converted->pitch);
+    SDL_FreeSurface(converted);
+    if (err < 0) {
+        sdlError("Atlas", "SDL_UpdateTexture");
+        atlasRemove(AtlasRegion{page.texture, p, x, y});
+        return none;
+    }
+
+    return Optional<AtlasRegion>(AtlasRegion{page.texture, p, x, y});
+}
+
+void
+atlasRemove(AtlasRegion region) noexcept {
+    if (region.page == -1) {
+        SDL_DestroyTexture(region.texture);
+        return;
+    }
+
+    Page& page = pages[region.page];
+    assert_(page.texture == region.texture);
+    assert_(page.numRegions > 0);
+
+    // Once a page is empty its texture is freed and its slot starts over.
+    page.numRegions -= 1;
+    if (page.numRegions == 0) {
+        SDL_DestroyTexture(page.texture);
+        page.texture = nullptr;
+        page.shelves.clear();
+        page.height = PADDING;
+        return;
+    }
+
+    // An emptied shelf is handed out again from the left. Emptied shelves at
+    // the bottom of the page are dropped instead, so that the space can be
+    // split into shelves of other heights.
+    Shelf& shelf = shelfAt(page, region.y);
+    assert_(shelf.numRegions > 0);
+    shelf.numRegions -= 1;
+    if (shelf.numRegions == 0) {
+        shelf.width = PADDING;
+    }
+    while (page.shelves.size() && page.shelves.back().numRegions == 0) {
+        page.height = page.shelves.back().y;
+        page.shelves.pop_back();
+    }
+}
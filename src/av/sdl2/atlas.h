@@ -0,0 +1,52 @@
+/********************************
+** Tsunagari Tile Engine       **
+** atlas.h                     **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#ifndef SRC_AV_SDL2_ATLAS_H_
+#define SRC_AV_SDL2_ATLAS_H_
+
+#include "av/sdl2/sdl2.h"
+#include "util/noexcept.h"
+#include "util/optional.h"
+
+// Where an image was placed on the GPU. Small images are packed together
+// into a few large atlas pages so that consecutive draws rarely have to
+// switch textures.
+struct AtlasRegion {
+    SDL_Texture* texture;
+    int page;  // -1 if the image was too large and has its own texture.
+    int x;
+    int y;
+};
+
+// Uploads the surface into an atlas page, or into a texture of its own if it
+// is too large to share one. Does not free the surface.
+Optional<AtlasRegion> atlasAdd(SDL_Surface* surface) noexcept;
+
+// Gives back a region. A page's texture is destroyed once all the regions
+// packed into it have been removed.
+void atlasRemove(AtlasRegion region) noexcept;
+
+#endif  // SRC_AV_SDL2_ATLAS_H_
@@ -24,8 +24,12 @@
 // IN THE SOFTWARE.
 // **********
 
+#include "av/sdl2/atlas.h"
+#include "av/sdl2/error.h"
 #include "av/sdl2/sdl2.h"
 #include "av/sdl2/window.h"
+#include "cache/cache-impl.h"
+#include "core/display-list.h"
 #include "core/images.h"
 #include "core/measure.h"
 #include "core/resources.h"
@@ -33,15 +37,16 @@
 #include "util/hashtable.h"
 #include "util/int.h"
 #include "util/noexcept.h"
+#include "util/optional.h"
 #include "util/pool.h"
 #include "util/string-view.h"
 #include "util/string.h"
+#include "util/vector.h"
 
 struct SDL2TiledImage {
-    int numUsers = 0;
-    time_t lastUse = 0;
+    int cacheHandle = -1;
 
-    SDL_Texture* texture = nullptr;
+    AtlasRegion region = {nullptr, -1, 0, 0};
     int width = 0;
     int height = 0;
     int tileWidth = 0;
@@ -51,191 +56,200 @@ struct SDL2TiledImage {
 
 static bool operator==(const SDL2TiledImage& a,
                        const SDL2TiledImage& b) noexcept {
-    return a.texture == b.texture;
+    return a.region.texture == b.region.texture;
 }
 
 struct SDL2Image {
-    enum { STANDALONE, FROM_TILED_IMAGE } origin = STANDALONE;
+    enum { STANDALONE, FROM_TILED_IMAGE, CANVAS } origin = STANDALONE;
 
-    int numUsers = 0;
-    time_t lastUse = 0;
+    int cacheHandle = -1;  // If STANDALONE.
 
-    SDL_Texture* texture = nullptr;
+    // Texture and offset into it. Owned if STANDALONE or CANVAS, otherwise
+    // shared with a TiledImage.
+    AtlasRegion region = {nullptr, -1, 0, 0};
     int width = 0;
     int height = 0;
-    int xoff = 0;  // Offset into texture if this is a part of a TiledImage.
-    int yoff = 0;  // Offset into texture if this is a part of a TiledImage.
 };
 
 static bool operator==(const SDL2Image& a, const SDL2Image& b) noexcept {
-    return a.texture == b.texture &&
-           a.xoff == b.xoff &&
-           a.yoff == b.yoff;
+    return a.region.texture == b.region.texture &&
+           a.region.x == b.region.x &&
+           a.region.y == b.region.y;
 }
 
-static Hashmap<String, ImageID> imageIDs;
-static Hashmap<String, TiledImageID> tiledImageIDs;
+static Cache<ImageID> images("Images");
+static Cache<TiledImageID> tiledImages("TiledImages");
 static Pool<SDL2Image> imagePool;
 static Pool<SDL2TiledImage> tiledImagePool;
 
-static SDL2Image
-makeImage(StringView path) {
-    Optional<StringView> r = Resources::load(path);
+// Reused between calls to Image::drawMany.
+static Vector<SDL_Vertex> vertices;
+static Vector<int> indices;
+
+// Decodes an image and uploads it into an atlas.
+static Optional<AtlasRegion>
+loadRegion(StringView path, int* width, int* height) noexcept {
+    Optional<Resource> r = Resources::load(path);
     if (!r) {
         // Error logged.
-        return SDL2Image();
+        return none;
     }
 
-    assert_(r->size < UINT32_MAX);
+    assert_(r->size() < UINT32_MAX);
 
     SDL_RWops* ops =
-            SDL_RWFromMem(static_cast<void*>(const_cast<char*>(r->data)),
-                          static_cast<int>(r->size));
-
-    SDL_Texture* texture;
-
-    {
-        TimeMeasure m(String() << "Constructed " << path << " as image");
-        // FIXME: Replace with IMG_LoadTexture_RW
-        SDL_Surface* surface = IMG_Load_RW(ops, 1);
-        if (!surface) {
-            SDL_FreeSurface(surface);
-            return SDL2Image();
-        }
-        SDL_Renderer* renderer = SDL2GameWindow::renderer;
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
-        if (!texture) {
-            // TODO: SDL_FreeSurace(surface); ??
-            return SDL2Image();
-        }
+            SDL_RWFromMem(static_cast<void*>(const_cast<char*>(r->data())),
+                          static_cast<int>(r->size()));
+
+    TimeMeasure m(String() << "Constructed " << path << " as image");
+
+    SDL_Surface* surface = IMG_Load_RW(ops, 1);
+    if (!surface) {
+        sdlError("Images", String() << "IMG_Load_RW(" << path << ")");
+        return none;
     }
 
-    int width;
-    int height;
-    SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+    *width = surface->w;
+    *height = surface->h;
 
-    assert_(width <= 4096);
-    assert_(height <= 4096);
+    assert_(*width <= 4096);
+    assert_(*height <= 4096);
 
-    int iid = imagePool.allocate();
-    SDL2Image& image = imagePool[iid];
-    image.origin = SDL2Image::STANDALONE;
-    image.numUsers = 1;
-    image.lastUse = 0;
-    image.texture = texture;
-    image.width = width;
-    image.height = height;
-    image.xoff = 0;
-    image.yoff = 0;
+    Optional<AtlasRegion> region = atlasAdd(surface);
+    SDL_FreeSurface(surface);
+    return region;
+}
 
+static SDL2Image
+makeImage(StringView path) noexcept {
+    SDL2Image image;
+
+    Optional<AtlasRegion> region =
+            loadRegion(path, &image.width, &image.height);
+    if (!region) {
+        return SDL2Image();
+    }
+
+    image.region = *region;
     return image;
 }
 
 static SDL2TiledImage
-makeTiledImage(StringView path, int tileWidth, int tileHeight) {
+makeTiledImage(StringView path, int tileWidth, int tileHeight) noexcept {
     assert_(tileWidth <= 4096);
     assert_(tileHeight <= 4096);
 
-    Optional<StringView> r = Resources::load(path);
-    if (!r) {
-        // Error logged.
-        return SDL2TiledImage();
-    }
-
-    assert_(r->size < UINT32_MAX);
+    SDL2TiledImage ti;
 
-    SDL_RWops* ops =
-            SDL_RWFromMem(static_cast<void*>(const_cast<char*>(r->data)),
-                          static_cast<int>(r->size));
-
-    SDL_Texture* texture;
-
-    {
-        TimeMeasure m(String() << "Constructed " << path << " as image");
-        SDL_Surface* surface = IMG_Load_RW(ops, 1);
-        if (!surface) {
-            SDL_FreeSurface(surface);
-            return SDL2TiledImage();
-        }
-        SDL_Renderer* renderer = SDL2GameWindow::renderer;
-        texture = SDL_CreateTextureFromSurface(renderer, surface);
-        if (!texture) {
-            // TODO: SDL_FreeSurace(surface); ??
-            return SDL2TiledImage();
-        }
+    Optional<AtlasRegion> region = loadRegion(path, &ti.width, &ti.height);
+    if (!region) {
+        return SDL2TiledImage();
     }
 
-    int width;
-    int height;
-    SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
-
-    assert_(width <= 4096);
-    assert_(height <= 4096);
-
-    int tiid = tiledImagePool.allocate();
-    SDL2TiledImage& ti = tiledImagePool[tiid];
-    ti.numUsers = 1;
-    ti.lastUse = 0;
-    ti.texture = texture;
-    ti.width = width;
-    ti.height = height;
+    ti.region = *region;
     ti.tileWidth = tileWidth;
     ti.tileHeight = tileHeight;
-    ti.numTiles = (width / tileWidth) * (height / tileHeight);
+    ti.numTiles = (ti.width / tileWidth) * (ti.height / tileHeight);
 
     return ti;
 }
 
+// Bytes used by a texture, assuming 32-bit pixels.
+static size_t
+textureCost(int width, int height) noexcept {
+    return static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
+}
+
 ImageID Images::load(StringView path) noexcept {
-    Optional<ImageID*> cachedId = imageIDs.tryAt(path);
-    if (cachedId) {
-        int iid = ***cachedId;
-        SDL2Image& image = imagePool[iid];
-        image.numUsers += 1;
-        return ImageID(iid);
+    CacheHandle handle = images.acquire(path);
+    if (handle) {
+        return images[*handle];
     }
 
     SDL2Image image = makeImage(path);
     if (image == SDL2Image()) {
-        imageIDs[path] = mark;
+        // Remember the failure until it ages out.
+        images.set(path, mark);
         return mark;
     }
 
     int iid = imagePool.allocate();
+    image.cacheHandle = images.set(
+            path, ImageID(iid), textureCost(image.width, image.height));
     imagePool[iid] = image;
 
-    imageIDs[path] = iid;
-
     return ImageID(iid);
 }
 
 TiledImageID Images::loadTiles(StringView path,
                                int tileWidth,
                                int tileHeight) noexcept {
-    Optional<TiledImageID*> cachedId = tiledImageIDs.tryAt(path);
-    if (cachedId) {
-        int tiid = ***cachedId;
-        SDL2TiledImage& tiledImage = tiledImagePool[tiid];
-        tiledImage.numUsers += 1;
-        return TiledImageID(tiid);
+    CacheHandle handle = tiledImages.acquire(path);
+    if (handle) {
+        return tiledImages[*handle];
     }
 
     SDL2TiledImage tiledImage = makeTiledImage(path, tileWidth, tileHeight);
     if (tiledImage == SDL2TiledImage()) {
-        tiledImageIDs[path] = mark;
+        tiledImages.set(path, mark);
         return mark;
     }
 
     int tiid = tiledImagePool.allocate();
+    tiledImage.cacheHandle = tiledImages.set(
+            path,
+            TiledImageID(tiid),
+            textureCost(tiledImage.width, tiledImage.height));
     tiledImagePool[tiid] = tiledImage;
 
-    tiledImageIDs[path] = tiid;
-
     return TiledImageID(tiid);
 }
 
+void Images::invalidate(StringView path) noexcept {
+    images.erase(path);
+    tiledImages.erase(path);
+}
+
 void Images::prune(time_t latestPermissibleUse) noexcept {
-    // TODO
+    images.garbageCollect(latestPermissibleUse, [](ImageID& iid) {
+        if (iid) {
+            atlasRemove(imagePool[*iid].region);
+            imagePool.release(*iid);
+        }
+    });
+
+    // Tiles handed out by getTile() share their TiledImage's region, so it
+    // is kept for as long as the TiledImage has a user.
+    tiledImages.garbageCollect(latestPermissibleUse, [](TiledImageID& tiid) {
+        if (tiid) {
+            atlasRemove(tiledImagePool[*tiid].region);
+            tiledImagePool.release(*tiid);
+        }
+    });
+}
+
+ImageID Images::makeCanvas(int width, int height) noexcept {
+    SDL_Texture* texture = SDL_CreateTexture(SDL2GameWindow::renderer,
+                                             SDL_PIXELFORMAT_ARGB8888,
+                                             SDL_TEXTUREACCESS_TARGET,
+                                             width,
+                                             height);
+    if (!texture) {
+        sdlError("Images", "SDL_CreateTexture");
+        return mark;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    SDL2Image image;
+    image.origin = SDL2Image::CANVAS;
+    image.region = AtlasRegion{texture, -1, 0, 0};
+    image.width = width;
+    image.height = height;
+
+    int iid = imagePool.allocate();
+    imagePool[iid] = image;
+
+    return ImageID(iid);
 }
 
 int TiledImage::size(TiledImageID tiid) noexcept {
@@ -245,41 +259,56 @@ int TiledImage::size(TiledImageID tiid) noexcept {
     return tiledImage.numTiles;
 }
 
-ImageID TiledImage::getTile(TiledImageID tiid, int i) noexcept {
-    assert_(tiid);
-
+static SDL2Image
+makeTile(TiledImageID tiid, int i) noexcept {
     SDL2TiledImage& ti = tiledImagePool[*tiid];
 
     int xoff = ti.tileWidth * static_cast<int>(i) % ti.width;
     int yoff = ti.tileWidth * static_cast<int>(i) / ti.width * ti.tileHeight;
 
-    int iid = imagePool.allocate();
-    SDL2Image& image = imagePool[iid];
+    SDL2Image image;
     image.origin = SDL2Image::FROM_TILED_IMAGE;
-    image.numUsers = 0;
-    image.lastUse = 0;
-    image.texture = ti.texture;
+    image.cacheHandle = -1;
+    image.region = ti.region;
+    image.region.x += xoff;
+    image.region.y += yoff;
     image.width = ti.tileWidth;
     image.height = ti.tileHeight;
-    image.xoff = xoff;
-    image.yoff = yoff;
+    return image;
+}
+
+ImageID TiledImage::getTile(TiledImageID tiid, int i) noexcept {
+    assert_(tiid);
+
+    int iid = imagePool.allocate();
+    imagePool[iid] = makeTile(tiid, i);
 
     return ImageID(iid);
 }
 
+void TiledImage::resetTile(TiledImageID tiid, int i, ImageID tile) noexcept {
+    assert_(tile);
+
+    SDL2Image& image = imagePool[*tile];
+    assert_(image.origin == SDL2Image::FROM_TILED_IMAGE);
+
+    if (tiid) {
+        image = makeTile(tiid, i);
+    }
+    else {
+        image.region = AtlasRegion{nullptr, -1, 0, 0};
+        image.width = 0;
+        image.height = 0;
+    }
+}
+
 void TiledImage::release(TiledImageID tiid) noexcept {
     if (!tiid) {
         return;
     }
 
     SDL2TiledImage& tiledImage = tiledImagePool[*tiid];
-
-    tiledImage.numUsers -= 1;
-    assert_(tiledImage.numUsers >= 0);
-
-    if (tiledImage.numUsers == 0) {
-        tiledImage.lastUse = World::time();
-    }
+    tiledImages.release(tiledImage.cacheHandle, World::time());
 }
 
 void Image::draw(ImageID iid, float x, float y, float z) noexcept {
@@ -291,12 +320,141 @@ void Image::draw(ImageID iid, float x, float y, float z) noexcept {
     rvec2 translation = SDL2GameWindow::translation;
     rvec2 scaling = SDL2GameWindow::scaling;
 
-    SDL_Rect src{i.xoff, i.yoff, i.width, i.height};
+    SDL_Rect src{i.region.x, i.region.y, i.width, i.height};
     SDL_Rect dst{static_cast<int>((x + translation.x) * scaling.x),
                  static_cast<int>((y + translation.y) * scaling.y),
                  static_cast<int>(i.width * scaling.x),
                  static_cast<int>(i.height * scaling.y)};
-    SDL_RenderCopy(renderer, i.texture, &src, &dst);
+    SDL_RenderCopy(renderer, i.region.texture, &src, &dst);
+}
+
+// Makes sure there are indices for the two triangles of each of numQuads
+// quads. They never change, so they are only built once.
+static void
+reserveQuadIndices(size_t numQuads) noexcept {
+    for (size_t q = indices.size() / 6; q < numQuads; q++) {
+        int v = static_cast<int>(q * 4);
+        indices.push_back(v + 0);
+        indices.push_back(v + 1);
+        indices.push_back(v + 2);
+        indices.push_back(v + 2);
+        indices.push_back(v + 1);
+        indices.push_back(v + 3);
+    }
+}
+
+// Draws items with the texture blend mode temporarily set to `mode`.
+static void
+drawBatches(const DisplayItem* items,
+            size_t count,
+            SDL_BlendMode mode) noexcept {
+    SDL_Renderer* renderer = SDL2GameWindow::renderer;
+    rvec2 translation = SDL2GameWindow::translation;
+    rvec2 scaling = SDL2GameWindow::scaling;
+
+    const SDL_Color white{0xFF, 0xFF, 0xFF, 0xFF};
+
+    // Items must be drawn in order, so submit each run of consecutive items
+    // that share a texture as one batch. With images packed into atlases,
+    // runs are long.
+    size_t i = 0;
+    while (i < count) {
+        assert_(items[i].image);
+
+        SDL_Texture* texture = imagePool[*items[i].image].region.texture;
+        if (!texture) {
+            // A tile whose image could not be loaded again.
+            i++;
+            continue;
+        }
+
+        int textureWidth;
+        int textureHeight;
+        SDL_QueryTexture(
+                texture, nullptr, nullptr, &textureWidth, &textureHeight);
+        float du = 1.0f / static_cast<float>(textureWidth);
+        float dv = 1.0f / static_cast<float>(textureHeight);
+
+        vertices.clear();
+
+        for (; i < count; i++) {
+            assert_(items[i].image);
+
+            SDL2Image& image = imagePool[*items[i].image];
+            if (image.region.texture != texture) {
+                break;
+            }
+
+            rvec2 dst = items[i].destination;
+            float x0 = (dst.x + translation.x) * scaling.x;
+            float y0 = (dst.y + translation.y) * scaling.y;
+            float x1 = (dst.x + image.width + translation.x) * scaling.x;
+            float y1 = (dst.y + image.height + translation.y) * scaling.y;
+
+            float u0 = image.region.x * du;
+            float v0 = image.region.y * dv;
+            float u1 = (image.region.x + image.width) * du;
+            float v1 = (image.region.y + image.height) * dv;
+
+            vertices.push_back(SDL_Vertex{{x0, y0}, white, {u0, v0}});
+            vertices.push_back(SDL_Vertex{{x1, y0}, white, {u1, v0}});
+            vertices.push_back(SDL_Vertex{{x0, y1}, white, {u0, v1}});
+            vertices.push_back(SDL_Vertex{{x1, y1}, white, {u1, v1}});
+        }
+
+        size_t numQuads = vertices.size() / 4;
+        reserveQuadIndices(numQuads);
+
+        if (mode != SDL_BLENDMODE_BLEND) {
+            SDL_SetTextureBlendMode(texture, mode);
+        }
+
+        SDL_RenderGeometry(renderer,
+                           texture,
+                           vertices.data(),
+                           static_cast<int>(vertices.size()),
+                           indices.data(),
+                           static_cast<int>(numQuads * 6));
+
+        if (mode != SDL_BLENDMODE_BLEND) {
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        }
+    }
+}
+
+void Image::drawMany(const DisplayItem* items, size_t count) noexcept {
+    drawBatches(items, count, SDL_BLENDMODE_BLEND);
+}
+
+void Image::drawOnto(ImageID canvas,
+                     const DisplayItem* items,
+                     size_t count) noexcept {
+    assert_(canvas);
+
+    SDL2Image& image = imagePool[*canvas];
+    assert_(image.origin == SDL2Image::CANVAS);
+
+    SDL_Renderer* renderer = SDL2GameWindow::renderer;
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    rvec2 translation = SDL2GameWindow::translation;
+    rvec2 scaling = SDL2GameWindow::scaling;
+
+    SDL2GameWindow::translation = {0, 0};
+    SDL2GameWindow::scaling = {1, 1};
+
+    SDL_SetRenderTarget(renderer, image.region.texture);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    // The images do not overlap, so copy their pixels as they are. Blending
+    // them onto the transparent canvas would darken partly transparent
+    // pixels once the canvas is itself blended onto the screen.
+    drawBatches(items, count, SDL_BLENDMODE_NONE);
+
+    SDL_SetRenderTarget(renderer, target);
+
+    SDL2GameWindow::translation = translation;
+    SDL2GameWindow::scaling = scaling;
 }
 
 int Image::width(ImageID iid) noexcept {
@@ -321,14 +479,13 @@ void Image::release(ImageID iid) noexcept {
     SDL2Image& image = imagePool[*iid];
 
     if (image.origin == SDL2Image::FROM_TILED_IMAGE) {
-        imagePool.release(iid);
+        imagePool.release(*iid);
+    }
+    else if (image.origin == SDL2Image::CANVAS) {
+        SDL_DestroyTexture(image.region.texture);
+        imagePool.release(*iid);
     }
     else {
-        image.numUsers -= 1;
-        assert_(image.numUsers >= 0);
-
-        if (image.numUsers == 0) {
-            image.lastUse = World::time();
-        }
+        images.release(image.cacheHandle, World::time());
     }
 }
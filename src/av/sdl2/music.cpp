@@ -26,12 +26,13 @@
 
 #include "av/sdl2/error.h"
 #include "av/sdl2/sdl2.h"
-#include "cache/rc-cache-impl.h"
-#include "cache/rc-reader-cache.h"
+#include "cache/cache-impl.h"
+#include "core/client-conf.h"
 #include "core/measure.h"
 #include "core/music-worker.h"
 #include "core/resources.h"
 #include "util/int.h"
+#include "util/move.h"
 #include "util/noexcept.h"
 #include "util/optional.h"
 #include "util/rc.h"
@@ -40,8 +41,9 @@
 struct SDL2Song {
     ~SDL2Song() noexcept;
 
-    // The Mix_Music needs the music data to be kept around for its lifetime.
-    StringView resource;
+    // Mix_Music streams from the music data, so it is held for the song's
+    // lifetime.
+    Optional<Resource> resource;
 
     Mix_Music* mix;
 };
@@ -49,35 +51,49 @@ struct SDL2Song {
 namespace {
 Rc<SDL2Song>
 genSong(StringView name) noexcept {
-    Optional<StringView> r = Resources::load(name);
+    Optional<Resource> r = Resources::load(name);
     if (!r) {
         // Error logged.
         return Rc<SDL2Song>();
     }
 
-    assert_(r->size < UINT32_MAX);
+    assert_(r->size() < UINT32_MAX);
 
     SDL_RWops* ops =
-            SDL_RWFromMem(static_cast<void*>(const_cast<char*>(r->data)),
-                          static_cast<int>(r->size));
+            SDL_RWFromMem(static_cast<void*>(const_cast<char*>(r->data())),
+                          static_cast<int>(r->size()));
 
     TimeMeasure m(String() << "Constructed " << name << " as music");
     Mix_Music* music = Mix_LoadMUS_RW(ops, 1);
 
     // We need to keep the memory (the resource) around, so put it in a struct.
     SDL2Song* song = new SDL2Song;
-    song->resource = *r;
+    song->resource = move_(r);
     song->mix = music;
 
     return Rc<SDL2Song>(song);
 }
 }
 
+static Cache<Rc<SDL2Song>> songs("Music");
+
+static Rc<SDL2Song>
+loadSong(StringView path) noexcept {
+    CacheHandle handle = songs.acquire(path);
+    if (handle) {
+        return songs[*handle];
+    }
+
+    // The song holds its data, which Resources already charges for.
+    Rc<SDL2Song> song = genSong(path);
+    songs.set(path, song);
+    return song;
+}
+
 static bool initalized = false;
 static String path;
 static int paused = 0;
 static Rc<SDL2Song> currentMusic;
-static RcReaderCache<Rc<SDL2Song>, genSong> songs;
 
 
 SDL2Song::~SDL2Song() noexcept {
@@ -125,7 +141,7 @@ MusicWorker::play(StringView path_) noexcept {
     if (currentMusic && !Mix_PausedMusic()) {
         Mix_HaltMusic();
     }
-    currentMusic = path.size() ? songs.lifetimeRequest(path) : Rc<SDL2Song>();
+    currentMusic = path.size() ? loadSong(path) : Rc<SDL2Song>();
     if (currentMusic) {
         Mix_PlayMusic(currentMusic->mix, -1);
     }
@@ -170,5 +186,5 @@ MusicWorker::resume() noexcept {
 
 void
 MusicWorker::garbageCollect() noexcept {
-    songs.garbageCollect();
+    songs.garbageCollect(World::time() - Conf::cacheTTL * 1000);
 }
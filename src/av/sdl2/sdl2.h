@@ -43,6 +43,7 @@ uint32_t SDL_WasInit(uint32_t flags) noexcept;
 
 // SDL_blendmode.h
 typedef enum {
+    SDL_BLENDMODE_NONE = 0x00000000,
     SDL_BLENDMODE_BLEND = 0x00000001,
 } SDL_BlendMode;
 
@@ -80,6 +81,8 @@ typedef enum {
     SDL_QUIT = 0x100,
     SDL_KEYDOWN = 0x300,
     SDL_KEYUP = 0x301,
+    SDL_RENDER_TARGETS_RESET = 0x2000,
+    SDL_RENDER_DEVICE_RESET = 0x2001,
 } SDL_EventType;
 typedef struct {
     uint32_t type, timestamp, windowID;
@@ -92,8 +95,19 @@ typedef union {
     uint8_t padding[56];
 } SDL_Event;
 int SDL_PollEvent(SDL_Event*) noexcept;
+int SDL_WaitEventTimeout(SDL_Event*, int) noexcept;
+
+// SDL_pixels.h
+typedef struct {
+    uint8_t r, g, b, a;
+} SDL_Color;
+typedef struct SDL_PixelFormat SDL_PixelFormat;
+#define SDL_PIXELFORMAT_ARGB8888 0x16362004
 
 // SDL_rect.h
+typedef struct {
+    float x, y;
+} SDL_FPoint;
 typedef struct {
     int x, y, w, h;
 } SDL_Rect;
@@ -102,8 +116,21 @@ typedef struct {
 typedef struct SDL_RWops SDL_RWops;
 SDL_RWops* SDL_RWFromMem(void*, int) noexcept;
 
+// SDL_stdinc.h
+void* SDL_calloc(size_t, size_t) noexcept;
+void SDL_free(void*) noexcept;
+
 // SDL_surface.h
-typedef struct SDL_Surface SDL_Surface;
+typedef struct SDL_Surface {  // Leading fields only.
+    uint32_t flags;
+    SDL_PixelFormat* format;
+    int w, h;
+    int pitch;
+    void* pixels;
+} SDL_Surface;
+SDL_Surface* SDL_ConvertSurfaceFormat(SDL_Surface*,
+                                      uint32_t,
+                                      uint32_t) noexcept;
 void SDL_FreeSurface(SDL_Surface*) noexcept;
 
 // SDL_video.h
@@ -142,10 +169,22 @@ typedef struct SDL_RendererInfo {
     int max_texture_width;
     int max_texture_height;
 } SDL_RendererInfo;
+typedef struct {
+    SDL_FPoint position;
+    SDL_Color color;
+    SDL_FPoint tex_coord;
+} SDL_Vertex;
 SDL_Renderer* SDL_CreateRenderer(SDL_Window*, int, uint32_t) noexcept;
+SDL_Texture* SDL_CreateTexture(SDL_Renderer*,
+                               uint32_t,
+                               int,
+                               int,
+                               int) noexcept;
 SDL_Texture* SDL_CreateTextureFromSurface(SDL_Renderer*, SDL_Surface*) noexcept;
 void SDL_DestroyTexture(SDL_Texture*) noexcept;
 int SDL_GetRendererInfo(SDL_Renderer*, SDL_RendererInfo*) noexcept;
+int SDL_GetRendererOutputSize(SDL_Renderer*, int*, int*) noexcept;
+SDL_Texture* SDL_GetRenderTarget(SDL_Renderer*) noexcept;
 int SDL_QueryTexture(SDL_Texture*, uint32_t*, int*, int*, int*) noexcept;
 int SDL_RenderClear(SDL_Renderer*) noexcept;
 int SDL_RenderCopy(SDL_Renderer*,
@@ -153,15 +192,30 @@ int SDL_RenderCopy(SDL_Renderer*,
                    const SDL_Rect*,
                    const SDL_Rect*) noexcept;
 int SDL_RenderFillRect(SDL_Renderer*, const SDL_Rect*) noexcept;
+int SDL_RenderGeometry(SDL_Renderer*,
+                       SDL_Texture*,
+                       const SDL_Vertex*,
+                       int,
+                       const int*,
+                       int) noexcept;
 void SDL_RenderPresent(SDL_Renderer*) noexcept;
+int SDL_RenderSetClipRect(SDL_Renderer*, const SDL_Rect*) noexcept;
 int SDL_SetRenderDrawBlendMode(SDL_Renderer*, SDL_BlendMode) noexcept;
 int SDL_SetRenderDrawColor(SDL_Renderer*,
                            uint8_t,
                            uint8_t,
                            uint8_t,
                            uint8_t) noexcept;
+int SDL_SetRenderTarget(SDL_Renderer*, SDL_Texture*) noexcept;
+int SDL_SetTextureBlendMode(SDL_Texture*, SDL_BlendMode) noexcept;
+int SDL_UpdateTexture(SDL_Texture*,
+                      const SDL_Rect*,
+                      const void*,
+                      int) noexcept;
 #define SDL_RENDERER_ACCELERATED 0x00000002
 #define SDL_RENDERER_PRESENTVSYNC 0x00000004
+#define SDL_TEXTUREACCESS_STATIC 0
+#define SDL_TEXTUREACCESS_TARGET 2
 
 // SDL_image library
 // SDL_image.h
@@ -169,7 +223,12 @@ SDL_Surface* IMG_Load_RW(SDL_RWops*, int) noexcept;
 
 // SDL_mixer library
 // SDL_mixer.h
-typedef struct Mix_Chunk Mix_Chunk;
+typedef struct Mix_Chunk {
+    int allocated;
+    uint8_t* abuf;
+    uint32_t alen;
+    uint8_t volume;
+} Mix_Chunk;
 typedef struct Mix_Music Mix_Music;
 int Mix_AllocateChannels(int) noexcept;
 void Mix_ChannelFinished(void (*)(int));
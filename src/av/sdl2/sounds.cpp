@@ -28,6 +28,7 @@
 
 #include "av/sdl2/error.h"
 #include "av/sdl2/sdl2.h"
+#include "cache/cache-impl.h"
 #include "core/measure.h"
 #include "core/resources.h"
 #include "core/world.h"
@@ -39,18 +40,13 @@
 #include "util/pool.h"
 
 struct SDL2Sound {
-    int numUsers;
-    time_t lastUse;
+    int cacheHandle;
 
-    StringView frames;  // Audio frames.
-    Mix_Chunk* chunk;   // Decoding configuration.
+    Mix_Chunk* chunk;  // Decoded audio frames.
 };
 
 static bool operator==(SDL2Sound a, SDL2Sound b) noexcept {
-    return a.numUsers == b.numUsers &&
-           a.lastUse == b.lastUse &&
-           a.frames == b.frames &&
-           a.chunk == b.chunk;
+    return a.cacheHandle == b.cacheHandle && a.chunk == b.chunk;
 }
 
 struct SDL2PlayingSound {
@@ -60,7 +56,7 @@ struct SDL2PlayingSound {
     int channel;
 };
 
-static Hashmap<String, SoundID> soundIDs;
+static Cache<SoundID> sounds("Sounds");
 static Pool<SDL2Sound> soundPool;
 static Pool<SDL2PlayingSound> playingSoundPool;
 
@@ -113,17 +109,18 @@ init() noexcept {
 
 static SDL2Sound
 makeSound(StringView path) noexcept {
-    Optional<StringView> r = Resources::load(path);
+    Optional<Resource> r = Resources::load(path);
     if (!r) {
         // Error logged.
         return SDL2Sound();
     }
 
-    assert_(r->size < UINT32_MAX);
+    assert_(r->size() < UINT32_MAX);
 
+    // Mix_LoadWAV_RW decodes the whole sound, so the resource can go after.
     SDL_RWops* ops =
-            SDL_RWFromMem(static_cast<void*>(const_cast<char*>(r->data)),
-                          static_cast<int>(r->size));
+            SDL_RWFromMem(static_cast<void*>(const_cast<char*>(r->data())),
+                          static_cast<int>(r->size()));
 
     Mix_Chunk* chunk;
 
@@ -137,38 +134,47 @@ makeSound(StringView path) noexcept {
         return SDL2Sound();
     }
 
-    return SDL2Sound{1, 0, *r, chunk};
+    return SDL2Sound{0, chunk};
 }
 
 SoundID
 Sounds::load(StringView path) noexcept {
     init();
 
-    Optional<SoundID*> cachedId = soundIDs.tryAt(path);
-    if (cachedId) {
-        int sid = ***cachedId;
-        SDL2Sound& sound = soundPool[sid];
-        sound.numUsers += 1;
-        return SoundID(sid);
+    CacheHandle handle = sounds.acquire(path);
+    if (handle) {
+        return sounds[*handle];
     }
 
     SDL2Sound sound = makeSound(path);
     if (sound == SDL2Sound()) {
-        soundIDs[path] = mark;
+        // Remember the failure until it ages out.
+        sounds.set(path, mark);
         return mark;
     }
 
+    // The cache pays for the decoded chunk.
     int sid = soundPool.allocate();
+    sound.cacheHandle = sounds.set(path, SoundID(sid), sound.chunk->alen);
     soundPool[sid] = sound;
 
-    soundIDs[path] = sid;
-
     return SoundID(sid);
 }
 
+void
+Sounds::invalidate(StringView path) noexcept {
+    sounds.erase(path);
+}
+
 void
 Sounds::prune(time_t latestPermissibleUse) noexcept {
-    // Mix_FreeChunk(chunk);
+    // SDL2_mixer halts any channel still playing a chunk before freeing it.
+    sounds.garbageCollect(latestPermissibleUse, [](SoundID& sid) {
+        if (sid) {
+            Mix_FreeChunk(soundPool[*sid].chunk);
+            soundPool.release(*sid);
+        }
+    });
 }
 
 PlayingSoundID
@@ -202,13 +208,7 @@ Sound::release(SoundID sid) noexcept {
     }
 
     SDL2Sound& sound = soundPool[*sid];
-
-    sound.numUsers -= 1;
-    assert_(sound.numUsers >= 0);
-
-    if (sound.numUsers == 0) {
-        sound.lastUse = World::time();
-    }
+    sounds.release(sound.cacheHandle, World::time());
 }
 
 bool
@@ -36,6 +36,7 @@
 #include "core/world.h"
 #include "os/chrono.h"
 #include "util/function.h"
+#include "util/math2.h"
 #include "util/noexcept.h"
 #include "util/optional.h"
 #include "util/transform.h"
@@ -49,6 +50,20 @@ static TimePoint start = SteadyClock::nowMS();
 static SDL_Window* window = nullptr;
 static Transform transform = Transform::identity();
 
+// Current clipping rectangle in renderer pixels, if any. See
+// GameWindow::clip.
+static Optional<SDL_Rect> clipRect;
+
+// Frames are drawn here and then copied to the window, so that the parts of
+// the last frame that did not change can be kept.
+static SDL_Texture* backBuffer = nullptr;
+static int backBufferWidth = 0;
+static int backBufferHeight = 0;
+
+// Set when the back buffer's contents were lost and every pixel must be drawn
+// again.
+static bool backBufferLost = true;
+
 static int
 getRefreshRate(SDL_Window* window) noexcept {
     // SDL_GetWindowDisplayIndex computes which display the window is on each
@@ -113,6 +128,14 @@ handleEvent(const SDL_Event& event) noexcept {
         exit(0);
         return;
 
+    case SDL_RENDER_TARGETS_RESET:
+    case SDL_RENDER_DEVICE_RESET:
+        // Target textures, such as the back buffer and tile chunk canvases,
+        // lose their contents.
+        backBufferLost = true;
+        World::canvasesLost();
+        return;
+
     default:
         return;
     }
@@ -228,6 +251,34 @@ GameWindow::setCaption(StringView caption) noexcept {
     SDL_SetWindowTitle(window, String(caption).null());
 }
 
+// Makes sure the back buffer matches the size of the renderer's output.
+static void
+updateBackBuffer() noexcept {
+    int w, h;
+    SDL_GetRendererOutputSize(SDL2GameWindow::renderer, &w, &h);
+
+    if (backBuffer && w == backBufferWidth && h == backBufferHeight) {
+        return;
+    }
+
+    if (backBuffer) {
+        SDL_DestroyTexture(backBuffer);
+    }
+
+    backBuffer = SDL_CreateTexture(SDL2GameWindow::renderer,
+                                   SDL_PIXELFORMAT_ARGB8888,
+                                   SDL_TEXTUREACCESS_TARGET,
+                                   w,
+                                   h);
+    if (!backBuffer) {
+        sdlDie("SDL2GameWindow", "SDL_CreateTexture");
+    }
+
+    backBufferWidth = w;
+    backBufferHeight = h;
+    backBufferLost = true;
+}
+
 void
 GameWindow::mainLoop() noexcept {
     SDL_ShowWindow(window);
@@ -265,15 +316,29 @@ GameWindow::mainLoop() noexcept {
         }
 
         bool drew = false;
-        if (World::needsRedraw()) {
+        if (World::needsRedraw() || backBufferLost) {
             drew = true;
 
             World::draw(&display);
 
-            SDL_SetRenderDrawColor(SDL2GameWindow::renderer, 0, 0, 0, 0xFF);
-            SDL_RenderClear(SDL2GameWindow::renderer);
+            updateBackBuffer();
+            if (backBufferLost) {
+                display.fullRedraw = true;
+                backBufferLost = false;
+            }
+
+            SDL_Renderer* renderer = SDL2GameWindow::renderer;
+
+            SDL_SetRenderTarget(renderer, backBuffer);
+            if (display.fullRedraw) {
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
+                SDL_RenderClear(renderer);
+            }
             displayListPresent(&display);
-            SDL_RenderPresent(SDL2GameWindow::renderer);
+            SDL_SetRenderTarget(renderer, nullptr);
+
+            SDL_RenderCopy(renderer, backBuffer, nullptr, nullptr);
+            SDL_RenderPresent(renderer);
 
             display.items.clear();
         }
@@ -289,6 +354,21 @@ GameWindow::mainLoop() noexcept {
             sleepDuration = 0;
         }
 
+        // If nothing can change for longer than a frame, wait for input or
+        // until then instead.
+        time_t idle = World::timeUntilWakeup();
+        if (ms_to_ns(idle) > sleepDuration) {
+            SDL_Event event;
+            if (SDL_WaitEventTimeout(&event, static_cast<int>(idle))) {
+                handleEvent(event);
+            }
+
+            previousFrameStart = frameStart;
+            frameStart = SteadyClock::now();
+            nextFrameStart = frameStart + idealFrameTime;
+            continue;
+        }
+
         if (!drew && sleepDuration) {
             SleepFor(sleepDuration);
         }
@@ -368,7 +448,33 @@ GameWindow::clip(float x,
                  float width,
                  float height,
                  Function<void()> op) noexcept {
+    rvec2 translation = SDL2GameWindow::translation;
+    rvec2 scaling = SDL2GameWindow::scaling;
+
+    // Cover every pixel the rectangle touches.
+    int x1 = static_cast<int>(floor((x + translation.x) * scaling.x));
+    int y1 = static_cast<int>(floor((y + translation.y) * scaling.y));
+    int x2 = static_cast<int>(ceil((x + width + translation.x) * scaling.x));
+    int y2 = static_cast<int>(ceil((y + height + translation.y) * scaling.y));
+
+    Optional<SDL_Rect> prev = clipRect;
+
+    // Nested clips only ever shrink.
+    if (prev) {
+        x1 = max(x1, prev->x);
+        y1 = max(y1, prev->y);
+        x2 = min(x2, prev->x + prev->w);
+        y2 = min(y2, prev->y + prev->h);
+    }
+
+    SDL_Rect rect{x1, y1, max(x2 - x1, 0), max(y2 - y1, 0)};
+    clipRect = Optional<SDL_Rect>(rect);
+    SDL_RenderSetClipRect(SDL2GameWindow::renderer, &rect);
+
     op();
+
+    clipRect = prev;
+    SDL_RenderSetClipRect(SDL2GameWindow::renderer, prev ? &*prev : nullptr);
 }
 
 void
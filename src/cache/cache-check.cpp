@@ -0,0 +1,174 @@
+/********************************
+** Tsunagari Tile Engine       **
+** cache-check.cpp             **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+// Exercises Cache on its own, with a clock the checks control. Prints each
+// failed check and exits non-zero if there were any.
+
+#include "cache/cache-impl.h"
+#include "core/images.h"
+#include "os/c.h"
+#include "util/int.h"
+#include "util/noexcept.h"
+#include "util/string-view.h"
+
+// Stand-ins for the parts of the engine Cache reads.
+time_t Conf::cacheTTL = 0;
+size_t Conf::cacheBudget = 0;
+
+static time_t now = 0;
+
+time_t
+World::time() noexcept {
+    return now;
+}
+
+void
+Log::info(StringView, StringView) noexcept {}
+
+static int failures = 0;
+
+#define CHECK(expr)                                                     \
+    do {                                                                \
+        if (!(expr)) {                                                  \
+            printf("%s:%d: %s failed\n", __FILE__, __LINE__, #expr);    \
+            failures += 1;                                              \
+        }                                                               \
+    } while (0)
+
+// Adds an entry and releases it at `at`, as if it were loaded and then put
+// down.
+static void
+setUnused(Cache<int>& cache, StringView key, size_t cost, time_t at) noexcept {
+    int handle = cache.set(key, 0, cost);
+    cache.release(handle, at);
+}
+
+// Over budget, entries are evicted least recently used first, and using an
+// entry again makes it the most recently used.
+static void
+checkLeastRecentlyUsedOrder() noexcept {
+    Cache<int> cache("LRU");
+    Conf::cacheBudget = 20;
+
+    setUnused(cache, "a", 10, 1000);
+    setUnused(cache, "b", 10, 2000);
+    setUnused(cache, "c", 10, 3000);
+
+    CacheHandle a = cache.acquire("a");
+    CHECK(a);
+    cache.release(*a, 4000);
+
+    now = 5000;
+    cache.garbageCollect(0);
+
+    CHECK(cache.contains("a"));
+    CHECK(!cache.contains("b"));
+    CHECK(cache.contains("c"));
+
+    Conf::cacheBudget = 10;
+    cache.garbageCollect(0);
+
+    CHECK(cache.contains("a"));
+    CHECK(!cache.contains("c"));
+    CHECK(cache.stats().evictions == 2);
+}
+
+// Entries are only evicted for the budget while the cache is over it, and
+// never while in use.
+static void
+checkBudgetEviction() noexcept {
+    Cache<int> cache("Budget");
+    Conf::cacheBudget = 30;
+
+    setUnused(cache, "a", 10, 1000);
+    setUnused(cache, "b", 10, 2000);
+    int held = cache.set("held", 0, 10);
+
+    now = 3000;
+    cache.garbageCollect(0);
+
+    CHECK(cache.stats().entries == 3);
+    CHECK(cache.stats().bytesResident == 30);
+
+    Conf::cacheBudget = 5;
+    cache.garbageCollect(0);
+
+    CHECK(!cache.contains("a"));
+    CHECK(!cache.contains("b"));
+    CHECK(cache.contains("held"));
+    CHECK(cache.stats().bytesResident == 10);
+
+    cache.release(held, 4000);
+    now = 5000;
+    cache.garbageCollect(0);
+
+    CHECK(!cache.contains("held"));
+    CHECK(cache.stats().entries == 0);
+    CHECK(cache.stats().bytesResident == 0);
+}
+
+// A failed load is cached so it is not retried every frame, but nobody holds
+// it, so acquiring it does not count a user and it still ages out.
+static void
+checkFailedLoadsAreNotUsers() noexcept {
+    Cache<ImageID> cache("Failed");
+    Conf::cacheBudget = 0;
+
+    CHECK(!cache.acquire("missing"));
+    cache.set("missing", mark);
+
+    CHECK(cache.acquire("missing"));
+    CHECK(cache.acquire("missing"));
+
+    // The first collection notes when it was last used.
+    now = 1000;
+    cache.garbageCollect(0);
+    CHECK(cache.contains("missing"));
+
+    now = 5000;
+    cache.garbageCollect(2000);
+    CHECK(!cache.contains("missing"));
+
+    CacheStats stats = cache.stats();
+    CHECK(stats.hits == 2);
+    CHECK(stats.misses == 1);
+    CHECK(stats.evictions == 1);
+}
+
+int
+main() noexcept {
+    checkLeastRecentlyUsedOrder();
+    checkBudgetEviction();
+    checkFailedLoadsAreNotUsers();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+
+    printf("All checks passed\n");
+    return 0;
+}
@@ -29,62 +29,216 @@
 #define SRC_CACHE_CACHE_IMPL_CPP_
 
 #include "cache/cache.h"
+#include "core/client-conf.h"
 #include "core/log.h"
+#include "core/world.h"
 #include "util/assert.h"
 #include "util/move.h"
+#include "util/optional.h"
+#include "util/sort.h"
+
+#define IN_USE_NOW -1
 
 template<typename T>
-Optional<T*>
+CacheHandle
 Cache<T>::acquire(StringView key) noexcept {
-    Optional<Entry*> e = entries.tryAt(key);
-    if (e) {
-        Log::info("Cache", String() << key << ": requested (cached)");
-        (*e)->numUsing += 1;
-        return Optional<X*>(&(*e)->data);
+    Optional<int*> handle = handles.tryAt(key);
+    if (!handle) {
+        counters.misses++;
+        Log::info(name, String() << key << ": requested");
+        return mark;
+    }
+
+    counters.hits++;
+
+    Entry& entry = entries[**handle];
+    if (CacheUsers<T>::counted(entry.data)) {
+        entry.numUsing += 1;
+    }
+    entry.lastUsed = IN_USE_NOW;
+
+    return CacheHandle(**handle);
+}
+
+template<typename T>
+void
+Cache<T>::release(int handle, time_t now) noexcept {
+    Entry& entry = entries[handle];
+
+    assert_(entry.live);
+    assert_(CacheUsers<T>::counted(entry.data));
+
+    entry.numUsing -= 1;
+    assert_(entry.numUsing >= 0);
+
+    if (entry.numUsing == 0) {
+        entry.lastUsed = now;
+    }
+}
+
+template<typename T>
+int
+Cache<T>::set(StringView key, T data, size_t cost) noexcept {
+    erase(key);
+
+    int handle;
+    if (freeHandles.size()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
     }
     else {
-        Log::info("Cache", String() << key << ": requested (not cached)");
-        return none;
+        handle = static_cast<int>(entries.size());
+        entries.push_back(Entry());
     }
+
+    Entry& entry = entries[handle];
+    entry.data = move_(data);
+    entry.key = key;
+    entry.cost = cost;
+    entry.lastUsed = IN_USE_NOW;
+    entry.numUsing = CacheUsers<T>::counted(entry.data) ? 1 : 0;
+    entry.live = true;
+    entry.forgotten = false;
+
+    handles[key] = handle;
+
+    counters.entries++;
+    counters.bytesResident += cost;
+
+    return handle;
+}
+
+template<typename T>
+T&
+Cache<T>::operator[](int handle) noexcept {
+    assert_(entries[handle].live);
+    return entries[handle].data;
+}
+
+template<typename T>
+bool
+Cache<T>::contains(StringView key) noexcept {
+    return handles.contains(key);
 }
 
 template<typename T>
 void
-Cache<T>::release(StringView key, time_t now) noexcept {
-    assert_(entries.contains(name);
+Cache<T>::erase(StringView key) noexcept {
+    auto it = handles.find(key);
+    if (it == handles.end()) {
+        return;
+    }
+    entries[it.value()].forgotten = true;
+    handles.erase(it);
+}
 
-    Entry& e = entries[key];
-    e.numUsing -= 1;
+template<typename T>
+bool
+Cache<T>::inUse(const Entry& entry) noexcept {
+    return entry.numUsing > 0 || CacheUsers<T>::shared(entry.data);
+}
 
-    assert_(e.numUsing >= 0);
+template<typename T>
+void
+Cache<T>::evict(int handle, Function<void(T&)>& onEvict) noexcept {
+    Entry& entry = entries[handle];
+
+    Log::info(name, String() << entry.key << ": purged");
 
-    if (e.numUsing == 0) {
-        e.lastUsed = now;
+    if (onEvict) {
+        onEvict(entry.data);
+    }
+    if (!entry.forgotten) {
+        handles.erase(entry.key);
     }
+
+    counters.evictions++;
+    counters.entries--;
+    counters.bytesResident -= entry.cost;
+
+    entries[handle] = Entry();
+    freeHandles.push_back(handle);
 }
 
 template<typename T>
 void
-Cache<T>::set(StringView key, T data) noexcept {
-    assert_(!entries.contains(key));
+Cache<T>::garbageCollect(time_t lastUsedBefore,
+                         Function<void(T&)> onEvict) noexcept {
+    time_t now = World::time();
+
+    for (int i = 0; i < static_cast<int>(entries.size()); i++) {
+        Entry& entry = entries[i];
+        if (!entry.live) {
+            continue;
+        }
+        if (inUse(entry)) {
+            entry.lastUsed = IN_USE_NOW;
+            continue;
+        }
+        if (entry.lastUsed == IN_USE_NOW) {
+            // Went unused since the last collection.
+            entry.lastUsed = now;
+        }
+        if (entry.forgotten || entry.lastUsed < lastUsedBefore) {
+            evict(i, onEvict);
+        }
+    }
+
+    if (Conf::cacheBudget != 0 && counters.bytesResident > Conf::cacheBudget) {
+        evictLeastRecentlyUsed(onEvict);
+    }
 
-    entries[key] = {move_(data), 1, 0};
+    Log::info(name,
+              String() << counters.entries << " entries, "
+                       << counters.bytesResident / 1024 << " KiB, "
+                       << counters.hits << " hits, " << counters.misses
+                       << " misses, " << counters.evictions << " evictions");
 }
 
 template<typename T>
 void
-Cache<T>::garbageCollect(time_t lastUsedBefore) noexcept {
-    for (auto it = entries.begin(); it != entries.end(); ) {
-        CacheEntry& entry = it.value();
-        if (entry.numUsed == 0 && entry.lastUsed < lastUsedBefore) {
-            StringView key = it.key();
-            Log::info("Cache", String() << key << ": purged");
-            it = entries.erase(it);
+Cache<T>::evictLeastRecentlyUsed(Function<void(T&)>& onEvict) noexcept {
+    // Every entry still live after the first pass of garbageCollect() that is
+    // not in use has a time in lastUsed.
+    unusedEntries.clear();
+    for (Entry& entry : entries) {
+        if (entry.live && entry.lastUsed != IN_USE_NOW) {
+            unusedEntries.push_back({entry.lastUsed, entry.cost});
+        }
+    }
+
+    pdqsort(unusedEntries.begin(), unusedEntries.end());
+
+    // Find the newest entry that has to go for the rest to fit. Entries used
+    // at the same time are evicted together, so this may free a little more
+    // than needed.
+    size_t cost = counters.bytesResident;
+    Optional<time_t> cutoff;
+    for (UnusedEntry& entry : unusedEntries) {
+        if (cost <= Conf::cacheBudget) {
+            break;
         }
-        else {
-            ++it;
+        cost -= entry.cost;
+        cutoff = entry.lastUsed;
+    }
+
+    if (!cutoff) {
+        return;
+    }
+
+    for (int i = 0; i < static_cast<int>(entries.size()); i++) {
+        Entry& entry = entries[i];
+        if (entry.live && entry.lastUsed != IN_USE_NOW &&
+            entry.lastUsed <= *cutoff) {
+            evict(i, onEvict);
         }
     }
 }
 
+template<typename T>
+CacheStats
+Cache<T>::stats() const noexcept {
+    return counters;
+}
+
 #endif  // SRC_CACHE_CACHE_IMPL_CPP_
@@ -28,29 +28,129 @@
 #ifndef SRC_CACHE_CACHE_H_
 #define SRC_CACHE_CACHE_H_
 
+#include "util/function.h"
 #include "util/hashtable.h"
+#include "util/int.h"
+#include "util/markable.h"
+#include "util/noexcept.h"
+#include "util/rc.h"
 #include "util/string-view.h"
 #include "util/string.h"
+#include "util/vector.h"
 
+// Counters for tuning Conf::cacheTTL and Conf::cacheBudget.
+struct CacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t bytesResident = 0;  // Sum of the costs of all entries.
+};
+
+// How a Cache knows whether an entry is in use. By default it counts calls to
+// acquire() and release(). A marked value records a failed load, which nobody
+// holds, so it has no users and ages out. Rc data counts its own references
+// instead, so it is in use while anything but the cache holds it.
+template<typename T>
+struct CacheUsers {
+    static bool counted(const T&) noexcept { return true; }
+
+    static bool shared(const T&) noexcept { return false; }
+};
+
+template<typename T, T MarkedValue>
+struct CacheUsers<Markable<T, MarkedValue>> {
+    static bool counted(const Markable<T, MarkedValue>& data) noexcept {
+        return data.exists();
+    }
+
+    static bool shared(const Markable<T, MarkedValue>&) noexcept {
+        return false;
+    }
+};
+
+template<typename T>
+struct CacheUsers<Rc<T>> {
+    static bool counted(const Rc<T>&) noexcept { return false; }
+
+    static bool shared(const Rc<T>& data) noexcept {
+        return data && !data.unique();
+    }
+};
+
+typedef Markable<int, -1> CacheHandle;
+
+// Data loaded from files, by path. Entries not in use are evicted by
+// garbageCollect() once they age out, or sooner, least recently used first,
+// while the cache holds more than Conf::cacheBudget bytes.
 template<typename T>
 class Cache {
  public:
-    Optional<T*> acquire(StringView key) noexcept;
-    void release(StringView key, time_t now) noexcept;
+    // `name` is used in log messages.
+    explicit Cache(StringView name) noexcept : name(name) {}
+
+    // Find the entry for a key and count one more user of it.
+    CacheHandle acquire(StringView key) noexcept;
+
+    // Count one less user of an entry.
+    void release(int handle, time_t now) noexcept;
+
+    // Add an entry with one user, as if it were acquired, unless its users
+    // are not counted. `cost` is roughly how many bytes the data takes up. An
+    // entry already under the key is forgotten, and evicted once its users
+    // release it.
+    int set(StringView key, T data, size_t cost = 0) noexcept;
+
+    // Invalidated by set().
+    T& operator[](int handle) noexcept;
+
+    bool contains(StringView key) noexcept;
+
+    // Forget the entry for a key. It is evicted once its users release it.
+    void erase(StringView key) noexcept;
 
-    void set(StringView key, T data) noexcept;
+    // Evict entries not in use since before `lastUsedBefore` and forgotten
+    // entries, then more as needed to fit the budget. `onEvict` is called on
+    // each entry's data before it is destroyed.
+    void garbageCollect(time_t lastUsedBefore,
+                        Function<void(T&)> onEvict = {}) noexcept;
 
-    void garbageCollect(time_t lastUsedBefore) noexcept;
+    CacheStats stats() const noexcept;
 
  private:
     struct Entry {
         T data;
-        int numUsing;
+        String key;
+        size_t cost = 0;
+        time_t lastUsed = 0;  // time in milliseconds
+        int numUsing = 0;
+        bool live = false;
+        bool forgotten = false;
+    };
+
+    struct UnusedEntry {
         time_t lastUsed;
+        size_t cost;
+
+        bool operator<(const UnusedEntry& other) const noexcept {
+            return lastUsed < other.lastUsed;
+        }
     };
 
-    Hashmap<String, Entry> entries;
+    bool inUse(const Entry& entry) noexcept;
+    void evict(int handle, Function<void(T&)>& onEvict) noexcept;
+    void evictLeastRecentlyUsed(Function<void(T&)>& onEvict) noexcept;
+
+    StringView name;
+
+    Hashmap<String, int> handles;
+    Vector<Entry> entries;
+    Vector<int> freeHandles;
+
+    CacheStats counters;
 
+    // Scratch space for evictLeastRecentlyUsed(), kept between calls.
+    Vector<UnusedEntry> unusedEntries;
 };
 
-#endif  // SRC_CORE_CACHE_H_
+#endif  // SRC_CACHE_CACHE_H_
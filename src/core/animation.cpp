@@ -64,6 +64,17 @@ Animation::needsRedraw(time_t now) const noexcept {
     return frame != frameShowing;
 }
 
+time_t
+Animation::nextFrameTime(time_t now) const noexcept {
+    assert_(frames.size() > 1);
+
+    if (needsRedraw(now)) {
+        return now;
+    }
+    time_t pos = now - offset;
+    return now + frameTime - pos % frameTime;
+}
+
 ImageID
 Animation::frame(time_t now) noexcept {
     assert_(now >= 0);
@@ -92,3 +103,8 @@ Animation::frame() const noexcept {
 
     return frames[frameShowing];
 }
+
+bool
+Animation::isAnimated() const noexcept {
+    return frames.size() > 1;
+}
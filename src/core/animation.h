@@ -83,6 +83,14 @@ class Animation {
      */
     bool needsRedraw(time_t now) const noexcept;
 
+    /**
+     * Returns the earliest time, not before now, at which needsRedraw() will
+     * be true. Must only be called on animated Animations.
+     *
+     * @now current time in milliseconds
+     */
+    time_t nextFrameTime(time_t now) const noexcept;
+
     /**
      * Returns the image that should be displayed at this time.
      *
@@ -95,6 +103,11 @@ class Animation {
      */
     ImageID frame() const noexcept;
 
+    /**
+     * Does this Animation have more than one frame?
+     */
+    bool isAnimated() const noexcept;
+
  private:
     /** List of images in animation. */
     Vector<ImageID> frames;
@@ -71,6 +71,7 @@ class AreaJSON : public Area {
     //! Parse an Area file.
     bool processDescriptor() noexcept;
     bool processMapProperties(Unique<JSONObject> obj) noexcept;
+    void prefetchResources(JSONArray& tilesets) noexcept;
     bool processTileSet(Unique<JSONObject> obj) noexcept;
     bool processTileSetFile(Rc<JSONObject> obj,
                             StringView source,
@@ -115,6 +116,9 @@ AreaJSON::AreaJSON(Player* player, StringView descriptor) noexcept {
     tileGraphics.resize(1);
 
     ok = processDescriptor();
+    if (ok) {
+        indexTiles();
+    }
 }
 
 void
@@ -152,6 +156,8 @@ AreaJSON::processDescriptor() noexcept {
     Unique<JSONArray> tilesets = doc->arrayAt("tilesets");
     CHECK(tilesets->size() > 0);
 
+    prefetchResources(*tilesets);
+
     for (size_t i = 0; i < tilesets->size(); i++) {
         CHECK(tilesets->isObject(i));
         CHECK(processTileSet(tilesets->objectAt(i)));
@@ -231,6 +237,96 @@ dirname(StringView path) noexcept {
     return !slash ? "" : path.substr(0, static_cast<size_t>(*slash) + 1);
 }
 
+/**
+ * Ask the resource provider to start reading this area's tileset images and
+ * music so that loading them below doesn't wait on the disk.
+ */
+void
+AreaJSON::prefetchResources(JSONArray& tilesets) noexcept {
+    Vector<String> paths;
+
+    for (size_t i = 0; i < tilesets.size(); i++) {
+        if (!tilesets.isObject(i)) {
+            continue;
+        }
+
+        Unique<JSONObject> tileset = tilesets.objectAt(i);
+        if (!tileset->hasString("source")) {
+            continue;
+        }
+
+        String source = String() << dirname(descriptor)
+                                 << tileset->stringAt("source");
+
+        // JSONs caches this document, so processTileSet() won't parse it
+        // again.
+        Rc<JSONObject> doc = JSONs::load(source);
+        if (doc && doc->hasString("image")) {
+            paths.push_back(String() << dirname(source)
+                                     << doc->stringAt("image"));
+        }
+    }
+
+    if (musicPath) {
+        paths.push_back(*musicPath);
+    }
+
+    Vector<StringView> views;
+    views.reserve(paths.size());
+    for (String& path : paths) {
+        views.push_back(path);
+    }
+
+    Resources::prefetch(move_(views));
+}
+
+void
+preloadAreaFromJSON(StringView filename) noexcept {
+    String descriptor = filename;
+
+    JSONs::loadAsync(
+            RESOURCE_LOAD_NEXT_AREA, filename, [descriptor](JSONObject& doc) {
+                if (doc.hasObject("properties")) {
+                    Unique<JSONObject> properties = doc.objectAt("properties");
+                    if (properties->hasString("music")) {
+                        Resources::loadAsync(RESOURCE_LOAD_NEXT_AREA,
+                                             properties->stringAt("music"));
+                    }
+                }
+
+                if (!doc.hasArray("tilesets")) {
+                    return;
+                }
+
+                Unique<JSONArray> tilesets = doc.arrayAt("tilesets");
+                for (size_t i = 0; i < tilesets->size(); i++) {
+                    if (!tilesets->isObject(i)) {
+                        continue;
+                    }
+
+                    Unique<JSONObject> tileset = tilesets->objectAt(i);
+                    if (!tileset->hasString("source")) {
+                        continue;
+                    }
+
+                    String source = String() << dirname(descriptor)
+                                             << tileset->stringAt("source");
+
+                    JSONs::loadAsync(
+                            RESOURCE_LOAD_NEXT_AREA,
+                            source,
+                            [source](JSONObject& doc) {
+                                if (doc.hasString("image")) {
+                                    Resources::loadAsync(
+                                            RESOURCE_LOAD_NEXT_AREA,
+                                            String() << dirname(source)
+                                                     << doc.stringAt("image"));
+                                }
+                            });
+                }
+            });
+}
+
 bool
 AreaJSON::processTileSet(Unique<JSONObject> obj) noexcept {
     /*
@@ -321,7 +417,7 @@ AreaJSON::processTileSetFile(Rc<JSONObject> obj,
     tileSets[imgSource] = TileSet{firstGid, (size_t)width, (size_t)height};
 
     // Load tileset image.
-    TiledImageID images = Images::loadTiles(imgSource, tilex, tiley);
+    TiledImageID images = tileSheets.load(imgSource, tilex, tiley);
     if (!images) {
         Log::err(descriptor, "Tileset image not found");
         return false;
@@ -332,7 +428,7 @@ AreaJSON::processTileSetFile(Rc<JSONObject> obj,
 
     // Initialize "vanilla" tile type array.
     for (int i = 0; i < nTiles; i++) {
-        ImageID image = TiledImage::getTile(images, i);
+        ImageID image = tileSheets.getTile(images, i);
         tileGraphics.push_back(Animation(image));
     }
 
@@ -440,7 +536,7 @@ AreaJSON::processTileType(Unique<JSONObject> obj,
                 return false;
             }
 
-            framesvec.push_back(TiledImage::getTile(images, idx_));
+            framesvec.push_back(tileSheets.getTile(images, idx_));
         }
     }
     if (obj->hasString("speed")) {
@@ -35,4 +35,8 @@ class Player;
 
 Area* makeAreaFromJSON(Player* player, StringView filename) noexcept;
 
+// Start reading and parsing an area's documents, and reading its tileset images
+// and music, on worker threads, so a later makeAreaFromJSON() has less to do.
+void preloadAreaFromJSON(StringView filename) noexcept;
+
 #endif  // SRC_CORE_AREA_JSON_H_
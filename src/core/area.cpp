@@ -46,9 +46,99 @@
 #include "util/assert.h"
 #include "util/hashtable.h"
 #include "util/math2.h"
+#include "util/radix-sort.h"
+#include "util/sort.h"
+#include "util/vector.h"
+
+// Tiles being drawn onto a chunk's canvas. Reused between chunks.
+static Vector<DisplayItem> chunkItems;
+
+// Finds the chunks, [from, to), that hold the given tiles. Looping areas can
+// see past their edges, where there are no chunks.
+static void
+visibleChunks(const TileGrid& grid,
+              const icube& tiles,
+              ivec2& from,
+              ivec2& to) noexcept {
+    from.x = bound(tiles.x1, 0, grid.dim.x) / TILE_CHUNK_SIZE;
+    from.y = bound(tiles.y1, 0, grid.dim.y) / TILE_CHUNK_SIZE;
+    to.x = (bound(tiles.x2, 0, grid.dim.x) + TILE_CHUNK_SIZE - 1) /
+           TILE_CHUNK_SIZE;
+    to.y = (bound(tiles.y2, 0, grid.dim.y) + TILE_CHUNK_SIZE - 1) /
+           TILE_CHUNK_SIZE;
+}
+
+// Sets `wakeup` to `next` if that is sooner.
+static void
+earliest(Optional<time_t>& wakeup, Optional<time_t> next) noexcept {
+    if (next && (!wakeup || *next < *wakeup)) {
+        wakeup = next;
+    }
+}
+
+// Added to the drawing order of overlays so that, where sprites overlap, they
+// are drawn after characters.
+static const uint64_t OVERLAY_ORDER = uint64_t(1) << 63;
+
+// Scratch space for sortByBottomEdge. Reused between frames.
+static Vector<RadixItem> sortKeys;
+static Vector<RadixItem> sortScratch;
+static Vector<DisplayItem> sortedItems;
+
+// Sorts the items from `first` on so that sprites lower on the screen are
+// drawn over those above them. Items whose bottom edges are on the same row
+// of pixels keep their order.
+static void
+sortByBottomEdge(Vector<DisplayItem>& items, size_t first) noexcept {
+    size_t n = items.size() - first;
+    if (n < 2) {
+        return;
+    }
+
+    sortKeys.resize(n);
+    sortScratch.resize(n);
+    sortedItems.resize(n);
+
+    for (size_t i = 0; i < n; i++) {
+        DisplayItem& item = items[first + i];
+
+        float bottom = item.destination.y;
+        if (item.image) {
+            bottom += static_cast<float>(Image::height(item.image));
+        }
+
+        // Flip the sign bit so that negative rows sort first.
+        int32_t row = static_cast<int32_t>(floor(bottom));
+        sortKeys[i].key = static_cast<uint32_t>(row) ^ 0x80000000u;
+        sortKeys[i].value = static_cast<uint32_t>(i);
+    }
+
+    radixSort(sortKeys.begin(), sortKeys.end(), sortScratch.begin());
+
+    for (size_t i = 0; i < n; i++) {
+        sortedItems[i] = items[first + sortKeys[i].value];
+    }
+    for (size_t i = 0; i < n; i++) {
+        items[first + i] = sortedItems[i];
+    }
+}
+
+Area::~Area() {
+    releaseChunks();
+}
 
 void
 Area::focus() {
+    if (tileSheets.released()) {
+        tileSheets.reload();
+        for (auto& c : characters) {
+            c->reloadSprite();
+        }
+        for (auto& o : overlays) {
+            o->reloadSprite();
+        }
+    }
+
     if (!beenFocused) {
         beenFocused = true;
         if (dataArea) {
@@ -63,6 +153,28 @@ Area::focus() {
     if (dataArea) {
         dataArea->onFocus();
     }
+
+    redraw = true;
+}
+
+void
+Area::unfocus() {
+    releaseChunks();
+}
+
+void
+Area::releaseImages() {
+    if (tileSheets.released()) {
+        return;
+    }
+
+    tileSheets.release();
+    for (auto& c : characters) {
+        c->releaseSprite();
+    }
+    for (auto& o : overlays) {
+        o->releaseSprite();
+    }
 }
 
 void
@@ -116,6 +228,20 @@ Area::draw(DisplayList* display) {
     assert_(tiles.z1 == 0);
     assert_(tiles.z2 == maxZ);
 
+    if (redraw) {
+        display->fullRedraw = true;
+    }
+
+    drawnEntities.clear();
+
+    // Keep chunks just off-screen so that scrolling back and forth does not
+    // redraw them, but free the rest.
+    ivec2 chunks = grid.chunkDim();
+    ivec2 from, to;
+    visibleChunks(grid, tiles, from, to);
+    keepChunks(ivec2{max(from.x - 1, 0), max(from.y - 1, 0)},
+               ivec2{min(to.x + 1, chunks.x), min(to.y + 1, chunks.y)});
+
     for (int z = 0; z < maxZ; z++) {
         switch (grid.layerTypes[z]) {
         case TileGrid::LayerType::TILE_LAYER:
@@ -127,6 +253,19 @@ Area::draw(DisplayList* display) {
         }
     }
 
+    // Entities only leave the Area after asking for a full redraw, so the
+    // ones from last frame are still alive unless this is one.
+    if (!display->fullRedraw) {
+        for (Entity* entity : lastDrawnEntities) {
+            entity->undraw(display);
+        }
+    }
+    drawnEntities.swap(lastDrawnEntities);
+
+    // Tile frames were just brought up to date.
+    grid.tilesChanged = false;
+    tileScheduleValid = false;
+
     redraw = false;
 }
 
@@ -149,49 +288,161 @@ Area::needsRedraw() {
     if (player->needsRedraw(pixels)) {
         return true;
     }
-    for (const auto& character : characters) {
-        if (character->needsRedraw(pixels)) {
-            return true;
+
+    for (int z = tiles.z1; z < tiles.z2; z++) {
+        findNearbyEntities(tiles, z);
+        for (IndexedEntity& e : nearbyEntities) {
+            if (e.entity->needsRedraw(pixels)) {
+                return true;
+            }
         }
     }
-    for (const auto& overlay : overlays) {
-        if (overlay->needsRedraw(pixels)) {
-            return true;
-        }
+
+    if (grid.tilesChanged) {
+        return true;
     }
 
     // Do any on-screen tile types need to update their animations?
+    time_t now = World::time();
+    updateTileSchedule(now);
+
+    return nextTileFrame && *nextTileFrame <= now;
+}
+
+Optional<time_t>
+Area::nextWakeup() {
+    time_t now = World::time();
+
+    if (redraw || grid.tilesChanged) {
+        return Optional<time_t>(now);
+    }
+
+    Optional<time_t> wakeup;
+
+    if (dataArea) {
+        earliest(wakeup, dataArea->nextWakeup(now));
+    }
+
+    earliest(wakeup, player->nextWakeup(now));
+    for (auto& character : characters) {
+        earliest(wakeup, character->nextWakeup(now));
+    }
+    for (auto& overlay : overlays) {
+        earliest(wakeup, overlay->nextWakeup(now));
+    }
+
+    updateTileSchedule(now);
+    earliest(wakeup, nextTileFrame);
+
+    return wakeup;
+}
+
+void
+Area::indexTiles() {
+    ivec2 chunks = grid.chunkDim();
+    int maxZ = grid.dim.z;
+    size_t numChunks = static_cast<size_t>(chunks.x * chunks.y * maxZ);
+
+    tileChunks.resize(numChunks);
+    chunkAnimations.resize(numChunks);
+    grid.dirtyChunks.resize(numChunks);
+    for (bool& dirty : grid.dirtyChunks) {
+        dirty = false;
+    }
+    entityBuckets.resize(numChunks);
+
+    for (int z = 0; z < maxZ; z++) {
+        for (int cy = 0; cy < chunks.y; cy++) {
+            for (int cx = 0; cx < chunks.x; cx++) {
+                indexChunkAnimations(cx, cy, z);
+            }
+        }
+    }
+}
+
+void
+Area::indexChunkAnimations(int cx, int cy, int z) {
+    Vector<int>& types =
+            chunkAnimations[grid.chunkIndex(icoord{cx * TILE_CHUNK_SIZE,
+                                                   cy * TILE_CHUNK_SIZE,
+                                                   z})];
+    types.clear();
+
+    if (grid.layerTypes[z] != TileGrid::LayerType::TILE_LAYER) {
+        return;
+    }
+
+    int x1 = cx * TILE_CHUNK_SIZE;
+    int y1 = cy * TILE_CHUNK_SIZE;
+    int x2 = min(x1 + TILE_CHUNK_SIZE, grid.dim.x);
+    int y2 = min(y1 + TILE_CHUNK_SIZE, grid.dim.y);
+
+    for (int y = y1; y < y2; y++) {
+        for (int x = x1; x < x2; x++) {
+            int type = grid.getTileType(icoord{x, y, z});
+
+            if (type == 0 || !tileGraphics[type].isAnimated()) {
+                continue;
+            }
+
+            bool listed = false;
+            for (int t : types) {
+                if (t == type) {
+                    listed = true;
+                    break;
+                }
+            }
+            if (!listed) {
+                types.push_back(type);
+            }
+        }
+    }
+}
+
+void
+Area::updateTileSchedule(time_t now) {
+    ivec2 from, to;
+    visibleChunks(grid, visibleTiles(), from, to);
+
+    if (!tileScheduleValid || from != scheduledFrom || to != scheduledTo) {
+        scheduleTileAnimations(from, to, now);
+    }
+}
+
+void
+Area::scheduleTileAnimations(ivec2 from, ivec2 to, time_t now) {
     checkedForAnimation.resize(static_cast<size_t>(tileGraphics.size()));
     for (bool& checked : checkedForAnimation) {
         checked = false;
     }
 
-    time_t now = World::time();
+    ivec2 chunks = grid.chunkDim();
 
-    for (int z = tiles.z1; z < tiles.z2; z++) {
-        if (grid.layerTypes[z] != TileGrid::LayerType::TILE_LAYER) {
-            continue;
-        }
-        for (int y = tiles.y1; y < tiles.y2; y++) {
-            for (int x = tiles.x1; x < tiles.x2; x++) {
-                int type = grid.getTileType(icoord{x, y, z});
+    nextTileFrame = none;
 
-                if (type == 0) {
-                    continue;
-                }
+    for (int z = 0; z < grid.dim.z; z++) {
+        for (int cy = from.y; cy < to.y; cy++) {
+            for (int cx = from.x; cx < to.x; cx++) {
+                int idx = (z * chunks.y + cy) * chunks.x + cx;
 
-                if (checkedForAnimation[type]) {
-                    continue;
-                }
-                checkedForAnimation[type] = true;
+                for (int type : chunkAnimations[idx]) {
+                    if (checkedForAnimation[type]) {
+                        continue;
+                    }
+                    checkedForAnimation[type] = true;
 
-                if (tileGraphics[type].needsRedraw(now)) {
-                    return true;
+                    time_t next = tileGraphics[type].nextFrameTime(now);
+                    if (!nextTileFrame || next < *nextTileFrame) {
+                        nextTileFrame = next;
+                    }
                 }
             }
         }
     }
-    return false;
+
+    tileScheduleValid = true;
+    scheduledFrom = from;
+    scheduledTo = to;
 }
 
 void
@@ -208,7 +459,13 @@ Area::tick(time_t dt) {
     for (auto& overlay : overlays) {
         overlay->tick(dt);
     }
-    erase_if(overlays, [](const Rc<Overlay>& o) { return o->isDead(); });
+    erase_if(overlays, [&](const Rc<Overlay>& o) {
+        bool dead = o->isDead();
+        if (dead) {
+            unindexEntity(o.get());
+        }
+        return dead;
+    });
 
     if (Conf::moveMode != Conf::TURN) {
         player->tick(dt);
@@ -216,9 +473,10 @@ Area::tick(time_t dt) {
         for (auto& character : characters) {
             character->tick(dt);
         }
-        erase_if(characters, [](const Rc<Character>& c) {
+        erase_if(characters, [&](const Rc<Character>& c) {
             bool dead = c->isDead();
             if (dead) {
+                unindexEntity(c.get());
                 c->setArea(nullptr, {0, 0, 0.0});
             }
             return dead;
@@ -239,9 +497,10 @@ Area::turn() {
     for (auto& character : characters) {
         character->turn();
     }
-    erase_if(characters, [](const Rc<Character>& c) {
+    erase_if(characters, [&](const Rc<Character>& c) {
         bool dead = c->isDead();
         if (dead) {
+            unindexEntity(c.get());
             c->setArea(nullptr, {0, 0, 0.0});
         }
         return dead;
@@ -312,7 +571,9 @@ Area::spawnNPC(StringView descriptor, vicoord coord, StringView phase) {
         return Rc<Character>();
     }
     c->setArea(this, coord);
+    c->drawOrder = entitiesSpawned++;
     characters.push_back(c);
+    indexEntity(c.get());
     return c;
 }
 
@@ -325,7 +586,9 @@ Area::spawnOverlay(StringView descriptor, vicoord coord, StringView phase) {
     }
     o->setArea(this);
     o->teleport(coord);
+    o->drawOrder = OVERLAY_ORDER | entitiesSpawned++;
     overlays.push_back(o);
+    indexEntity(o.get());
     return o;
 }
 
@@ -352,60 +615,315 @@ Area::drawTiles(DisplayList* display, const icube& tiles, int z) {
     time_t now = World::time();
 
     tilesAnimated.resize(static_cast<size_t>(tileGraphics.size()));
+    tileFramesChanged.resize(static_cast<size_t>(tileGraphics.size()));
     for (bool& animated : tilesAnimated) {
         animated = false;
     }
 
-    display->items.reserve(display->items.size() +
-                           (tiles.y2 - tiles.y1) * (tiles.x2 - tiles.x1));
+    int width = grid.tileDim.x;
+    int height = grid.tileDim.y;
+
+    ivec2 chunks = grid.chunkDim();
+    ivec2 from, to;
+    visibleChunks(grid, tiles, from, to);
+    int cx1 = from.x;
+    int cy1 = from.y;
+    int cx2 = to.x;
+    int cy2 = to.y;
+
+    // Chunks outside the kept ones are not rendered, so they can wait to be
+    // cleaned until they come back into view.
+    for (int cy = keptChunksFrom.y; cy < keptChunksTo.y; cy++) {
+        for (int cx = keptChunksFrom.x; cx < keptChunksTo.x; cx++) {
+            int idx = (z * chunks.y + cy) * chunks.x + cx;
+            TileChunk& chunk = tileChunks[idx];
+
+            if (grid.dirtyChunks[idx]) {
+                grid.dirtyChunks[idx] = false;
+                releaseChunk(chunk);
+                indexChunkAnimations(cx, cy, z);
+            }
 
-    // float depth = grid.idx2depth[(size_t)z];
+            if (cx < cx1 || cx >= cx2 || cy < cy1 || cy >= cy2) {
+                continue;
+            }
+
+            if (!chunk.rendered) {
+                renderChunk(chunk, cx, cy, z);
 
-    int width = 16;
-    int height = 16;
+                float x = float(cx * TILE_CHUNK_SIZE * width);
+                float y = float(cy * TILE_CHUNK_SIZE * height);
+                display->dirtyRects.push_back(DisplayRect{
+                        x,
+                        y,
+                        x + float(TILE_CHUNK_SIZE * width),
+                        y + float(TILE_CHUNK_SIZE * height)});
+            }
 
-    for (int y = tiles.y1; y < tiles.y2; y++) {
-        for (int x = tiles.x1; x < tiles.x2; x++) {
-            // We are certain the Tile exists.
+            if (chunk.canvas) {
+                rvec2 drawPos{float(cx * TILE_CHUNK_SIZE * width),
+                              float(cy * TILE_CHUNK_SIZE * height)};
+                display->items.push_back(DisplayItem{chunk.canvas, drawPos});
+            }
+
+            for (icoord tile : chunk.looseTiles) {
+                int type = grid.getTileType(tile);
+
+                if (!tilesAnimated[type]) {
+                    tilesAnimated[type] = true;
+                    ImageID before = tileGraphics[type].frame();
+                    tileFramesChanged[type] =
+                            tileGraphics[type].frame(now) != before;
+                }
+
+                rvec2 drawPos{float(tile.x * width), float(tile.y * height)};
+
+                if (tileFramesChanged[type]) {
+                    display->dirtyRects.push_back(
+                            DisplayRect{drawPos.x,
+                                        drawPos.y,
+                                        drawPos.x + float(width),
+                                        drawPos.y + float(height)});
+                }
+
+                ImageID img = tileGraphics[type].frame();
+                if (img) {
+                    // drawPos.z = depth + drawPos.y / tileDimY *
+                    // ISOMETRIC_ZOFF_PER_TILE;
+                    display->items.push_back(DisplayItem{img, drawPos});
+                }
+            }
+        }
+    }
+}
+
+void
+Area::renderChunk(TileChunk& chunk, int cx, int cy, int z) {
+    int width = grid.tileDim.x;
+    int height = grid.tileDim.y;
+
+    int x1 = cx * TILE_CHUNK_SIZE;
+    int y1 = cy * TILE_CHUNK_SIZE;
+    int x2 = min(x1 + TILE_CHUNK_SIZE, grid.dim.x);
+    int y2 = min(y1 + TILE_CHUNK_SIZE, grid.dim.y);
+
+    chunkItems.clear();
+
+    for (int y = y1; y < y2; y++) {
+        for (int x = x1; x < x2; x++) {
             int type = grid.getTileType(icoord{x, y, z});
 
             if (type == 0) {
                 continue;
             }
 
-            if (!tilesAnimated[type]) {
-                tilesAnimated[type] = true;
-                tileGraphics[type].frame(now);
+            Animation& graphic = tileGraphics[type];
+            if (graphic.isAnimated()) {
+                chunk.looseTiles.push_back(icoord{x, y, z});
+                continue;
             }
 
-            ImageID img = tileGraphics[type].frame();
+            ImageID img = graphic.frame();
             if (img) {
-                rvec2 drawPos{float(x * width), float(y * height)};
-                // drawPos.z = depth + drawPos.y / tileDimY *
-                // ISOMETRIC_ZOFF_PER_TILE;
-                display->items.push_back_nogrow(DisplayItem{img, drawPos});
+                rvec2 drawPos{float((x - x1) * width), float((y - y1) * height)};
+                chunkItems.push_back(DisplayItem{img, drawPos});
             }
         }
     }
+
+    if (!chunkItems.empty()) {
+        chunk.canvas =
+                Images::makeCanvas((x2 - x1) * width, (y2 - y1) * height);
+        if (chunk.canvas) {
+            Image::drawOnto(chunk.canvas, chunkItems.data(), chunkItems.size());
+        }
+        else {
+            // Error logged. Draw the tiles one at a time instead.
+            for (int y = y1; y < y2; y++) {
+                for (int x = x1; x < x2; x++) {
+                    int type = grid.getTileType(icoord{x, y, z});
+                    if (type != 0 && !tileGraphics[type].isAnimated()) {
+                        chunk.looseTiles.push_back(icoord{x, y, z});
+                    }
+                }
+            }
+        }
+    }
+
+    chunk.rendered = true;
+}
+
+void
+Area::releaseChunk(TileChunk& chunk) {
+    if (!chunk.rendered) {
+        return;
+    }
+
+    Image::release(chunk.canvas);
+    chunk.canvas = mark;
+    chunk.looseTiles.clear();
+    chunk.rendered = false;
 }
 
 void
-Area::drawEntities(DisplayList* display, const icube& tiles, int z) {
-    float depth = grid.idx2depth[(size_t)z];
+Area::releaseChunks() {
+    for (TileChunk& chunk : tileChunks) {
+        releaseChunk(chunk);
+    }
+    redraw = true;
+}
 
-    for (auto& character : characters) {
-        if (character->getTileCoords_i().z == z) {
-            character->draw(display);
-        }
+void
+Area::keepChunks(ivec2 from, ivec2 to) {
+    if (from == keptChunksFrom && to == keptChunksTo) {
+        return;
     }
 
-    for (auto& overlay : overlays) {
-        if (overlay->getPixelCoord().z == depth) {
-            overlay->draw(display);
+    ivec2 chunks = grid.chunkDim();
+
+    for (int z = 0; z < grid.dim.z; z++) {
+        for (int cy = keptChunksFrom.y; cy < keptChunksTo.y; cy++) {
+            for (int cx = keptChunksFrom.x; cx < keptChunksTo.x; cx++) {
+                if (from.x <= cx && cx < to.x && from.y <= cy && cy < to.y) {
+                    continue;
+                }
+
+                int idx = (z * chunks.y + cy) * chunks.x + cx;
+                releaseChunk(tileChunks[idx]);
+            }
         }
     }
 
+    keptChunksFrom = from;
+    keptChunksTo = to;
+}
+
+void
+Area::drawEntities(DisplayList* display, const icube& tiles, int z) {
+    size_t first = display->items.size();
+
+    // Where sprites overlap, ties are broken with characters before
+    // overlays, each in the order they were added, and the player last.
+    findNearbyEntities(tiles, z);
+    pdqsort(nearbyEntities.begin(), nearbyEntities.end());
+
+    for (IndexedEntity& e : nearbyEntities) {
+        e.entity->draw(display);
+        drawnEntities.push_back(e.entity);
+    }
+
     if (player->getTileCoords_i().z == z) {
         player->draw(display);
+        drawnEntities.push_back(player);
+    }
+
+    sortByBottomEdge(display->items, first);
+}
+
+void
+Area::entityMoved(Entity* entity) {
+    if (entity->drawBucket != ENTITY_NOT_INDEXED) {
+        indexEntity(entity);
+    }
+}
+
+void
+Area::indexEntity(Entity* entity) {
+    rcoord r = entity->getPixelCoord();
+
+    int bucket = ENTITY_OFF_LAYER;
+    int z = 0;
+
+    Optional<int*> z_ = grid.depth2idx.tryAt(r.z);
+    if (z_) {
+        z = **z_;
+
+        // Sprites up to a chunk in size are found by searching one chunk
+        // past the visible tiles.
+        int chunkWidth = TILE_CHUNK_SIZE * grid.tileDim.x;
+        int chunkHeight = TILE_CHUNK_SIZE * grid.tileDim.y;
+
+        int x = static_cast<int>(floor(r.x / grid.tileDim.x));
+        int y = static_cast<int>(floor(r.y / grid.tileDim.y));
+        ivec2 size = entity->getImageSize();
+
+        if (0 <= x && x < grid.dim.x && 0 <= y && y < grid.dim.y &&
+            size.x <= chunkWidth && size.y <= chunkHeight) {
+            bucket = grid.chunkIndex(icoord{x, y, z});
+        }
+        else {
+            bucket = ENTITY_UNBUCKETED;
+        }
+    }
+
+    // A chunk index includes the layer, so staying in the same chunk means
+    // nothing changed.
+    if (bucket >= 0 && bucket == entity->drawBucket) {
+        return;
+    }
+
+    unindexEntity(entity);
+    entity->drawBucket = bucket;
+
+    IndexedEntity e{entity, z, entity->drawOrder};
+    if (bucket >= 0) {
+        entityBuckets[bucket].push_back(e);
+    }
+    else if (bucket == ENTITY_UNBUCKETED) {
+        unbucketedEntities.push_back(e);
+    }
+}
+
+void
+Area::unindexEntity(Entity* entity) {
+    // Order within a bucket does not matter, since entities are sorted after
+    // they are gathered for drawing.
+    auto remove = [&](Vector<IndexedEntity>& entities) {
+        for (size_t i = 0; i < entities.size(); i++) {
+            if (entities[i].entity == entity) {
+                entities[i] = entities.back();
+                entities.pop_back();
+                return;
+            }
+        }
+    };
+
+    int bucket = entity->drawBucket;
+    if (bucket >= 0) {
+        remove(entityBuckets[bucket]);
+    }
+    else if (bucket == ENTITY_UNBUCKETED) {
+        remove(unbucketedEntities);
+    }
+    entity->drawBucket = ENTITY_NOT_INDEXED;
+}
+
+void
+Area::findNearbyEntities(const icube& tiles, int z) {
+    ivec2 chunks = grid.chunkDim();
+    int cx1 = max(bound(tiles.x1, 0, grid.dim.x) / TILE_CHUNK_SIZE - 1, 0);
+    int cy1 = max(bound(tiles.y1, 0, grid.dim.y) / TILE_CHUNK_SIZE - 1, 0);
+    int cx2 = min((bound(tiles.x2, 0, grid.dim.x) + TILE_CHUNK_SIZE - 1) /
+                                  TILE_CHUNK_SIZE + 1,
+                  chunks.x);
+    int cy2 = min((bound(tiles.y2, 0, grid.dim.y) + TILE_CHUNK_SIZE - 1) /
+                                  TILE_CHUNK_SIZE + 1,
+                  chunks.y);
+
+    nearbyEntities.clear();
+
+    for (int cy = cy1; cy < cy2; cy++) {
+        for (int cx = cx1; cx < cx2; cx++) {
+            int idx = (z * chunks.y + cy) * chunks.x + cx;
+            for (IndexedEntity& e : entityBuckets[idx]) {
+                nearbyEntities.push_back(e);
+            }
+        }
+    }
+
+    for (IndexedEntity& e : unbucketedEntities) {
+        if (e.z == z) {
+            nearbyEntities.push_back(e);
+        }
     }
 }
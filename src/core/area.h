@@ -31,6 +31,7 @@
 #include "core/animation.h"
 #include "core/keyboard.h"
 #include "core/tile-grid.h"
+#include "core/tile-sheets.h"
 #include "core/tile.h"
 #include "core/vec.h"
 #include "util/hashtable.h"
@@ -63,9 +64,24 @@ class Player;
 */
 class Area {
  public:
+    virtual ~Area();
+
     //! Prepare game state for this Area to be in focus.
     void focus();
 
+    //! Free per-focus state, such as tile chunk canvases, once another Area
+    //! takes focus.
+    void unfocus();
+
+    //! Drop every tile chunk canvas so they are drawn again from the tiles,
+    //! for example because their contents were lost.
+    void releaseChunks();
+
+    //! Let the image cache free this Area's tilesets and the sprites of its
+    //! characters and overlays while it is out of focus. The Area keeps the
+    //! rest of its state, and focus() loads the images again.
+    void releaseImages();
+
     //! Processes keyboard input, calling the Player object when necessary.
     void buttonDown(KeyboardKey key);
     void buttonUp(KeyboardKey key);
@@ -79,6 +95,10 @@ class Area {
     //! Inform the Area that a redraw is needed.
     void requestRedraw();
 
+    //! The earliest time at which ticking or drawing the Area could change
+    //! anything, or none if it will stay the same until input arrives.
+    Optional<time_t> nextWakeup();
+
     /**
      * Update the game state within this Area as if dt milliseconds had
      * passed since the last call. Updates Entities, runs scripts, and
@@ -115,6 +135,10 @@ class Area {
 
     DataArea* getDataArea();
 
+    //! Called by a character or overlay in this Area whenever its position
+    //! changes, so that it is drawn from the right chunk.
+    void entityMoved(Entity* entity);
+
     void runScript(TileGrid::ScriptType type,
                    icoord tile,
                    Entity* triggeredBy) noexcept;
@@ -124,17 +148,127 @@ class Area {
 
     bool ok = true;
 
+    //! When the Area last lost focus, in World::time(). Areas left behind
+    //! for long enough release their images.
+    time_t leftAt = 0;
+
  protected:
     //! Calculate frame to show for each type of tile
     void drawTiles(DisplayList* display, const icube& tiles, int z);
     void drawEntities(DisplayList* display, const icube& tiles, int z);
 
+    struct TileChunk;
+
+    //! Set up per-chunk state once the grid and tile types have loaded.
+    void indexTiles();
+
+    //! List the animated tile types that appear in one chunk.
+    void indexChunkAnimations(int cx, int cy, int z);
+
+    //! Find when the next visible animated tile will change frames, unless
+    //! that is already known.
+    void updateTileSchedule(time_t now);
+    void scheduleTileAnimations(ivec2 from, ivec2 to, time_t now);
+
+    //! Draw a chunk's unchanging tiles onto a canvas, and list the others.
+    void renderChunk(TileChunk& chunk, int cx, int cy, int z);
+    void releaseChunk(TileChunk& chunk);
+
+    //! Release the canvases of chunks that leave the kept range, [from, to),
+    //! on every layer.
+    void keepChunks(ivec2 from, ivec2 to);
+
+    //! Put a character or overlay into entityBuckets, or move it to the
+    //! bucket for where it now stands.
+    void indexEntity(Entity* entity);
+
+    //! Take a character or overlay out of entityBuckets.
+    void unindexEntity(Entity* entity);
+
+    //! Fill nearbyEntities with the characters and overlays on layer z that
+    //! stand in or next to a chunk of visible tiles.
+    void findNearbyEntities(const icube& tiles, int z);
+
  protected:
     Hashmap<String, TileSet> tileSets;
 
+    //! Tileset images and the tiles taken from them.
+    TileSheets tileSheets;
+
     Vector<Animation> tileGraphics;
     Vector<bool> checkedForAnimation;
+
+    //! The distinct animated tile types in each chunk. Indexed by
+    //! TileGrid::chunkIndex().
+    Vector<Vector<int>> chunkAnimations;
+
+    //! The range of chunks, [from, to), that nextTileFrame covers. Unset
+    //! whenever a tile's frame might have changed.
+    bool tileScheduleValid = false;
+    ivec2 scheduledFrom, scheduledTo;
+
+    //! When a visible animated tile next changes frames, if any are visible.
+    Optional<time_t> nextTileFrame;
     Vector<bool> tilesAnimated;
+    Vector<bool> tileFramesChanged;
+
+    //! A square of tiles on one tile layer. Tiles that never change are drawn
+    //! once onto a canvas, which is then drawn in their place each frame.
+    struct TileChunk {
+        bool rendered = false;
+
+        //! Not set if the chunk has no unchanging tiles.
+        ImageID canvas;
+
+        //! Tiles that must still be drawn one at a time, such as animated
+        //! ones.
+        Vector<icoord> looseTiles;
+    };
+
+    //! Indexed by TileGrid::chunkIndex().
+    Vector<TileChunk> tileChunks;
+
+    //! The chunks, [from, to), that may hold canvases: those on screen and a
+    //! margin of one around them.
+    ivec2 keptChunksFrom = {0, 0};
+    ivec2 keptChunksTo = {0, 0};
+
+    //! A character or overlay and its place in drawing order.
+    struct IndexedEntity {
+        Entity* entity;
+        int z;
+        uint64_t order;
+
+        bool operator<(const IndexedEntity& other) const noexcept {
+            return order < other.order;
+        }
+    };
+
+    //! Characters and overlays by the chunk they stand in, so that drawing
+    //! need only look near the screen. Indexed by TileGrid::chunkIndex().
+    Vector<Vector<IndexedEntity>> entityBuckets;
+
+    //! Entities off the grid or too large to find by chunk. Always looked at.
+    Vector<IndexedEntity> unbucketedEntities;
+
+    //! Where an Entity is kept, besides an index into entityBuckets. See
+    //! Entity::drawBucket.
+    enum {
+        ENTITY_NOT_INDEXED = -1,
+        ENTITY_OFF_LAYER = -2,
+        ENTITY_UNBUCKETED = -3,
+    };
+
+    //! Counts characters and overlays spawned, to give each its drawing
+    //! order.
+    uint64_t entitiesSpawned = 0;
+
+    Vector<IndexedEntity> nearbyEntities;
+
+    //! Entities drawn in the last frame and in this one, so that those no
+    //! longer drawn can have their old places painted over.
+    Vector<Entity*> drawnEntities;
+    Vector<Entity*> lastDrawnEntities;
 
     Vector<Rc<Character>> characters;
     Vector<Rc<Overlay>> overlays;
@@ -81,6 +81,7 @@ Character::setTileCoords(int x, int y) noexcept {
     leaveTile();
     redraw = true;
     r = area->grid.virt2virt(vicoord{x, y, r.z});
+    moved();
     enterTile();
 }
 
@@ -89,6 +90,7 @@ Character::setTileCoords(icoord phys) noexcept {
     leaveTile();
     redraw = true;
     r = area->grid.phys2virt_r(phys);
+    moved();
     enterTile();
 }
 
@@ -97,6 +99,7 @@ Character::setTileCoords(vicoord virt) noexcept {
     leaveTile();
     redraw = true;
     r = area->grid.virt2virt(virt);
+    moved();
     enterTile();
 }
 
@@ -105,6 +108,7 @@ Character::setTileCoords(rcoord virt) noexcept {
     leaveTile();
     redraw = true;
     r = virt;
+    moved();
     enterTile();
 }
 
@@ -113,6 +117,7 @@ Character::setArea(Area* area, vicoord position) noexcept {
     leaveTile();
     Entity::setArea(area);
     r = area->grid.virt2virt(position);
+    moved();
     enterTile();
     redraw = true;
 }
@@ -167,6 +172,7 @@ Character::moveByTile(ivec2 delta) noexcept {
         // Movement is instantaneous.
         redraw = true;
         r = destCoord;
+        moved();
         moving = false;
         setAnimationStanding();
         arrived();
@@ -239,6 +245,7 @@ Character::arrived() noexcept {
             area->grid.layermods[EXIT_NORMAL].tryAt(dest);
         if (layermod) {
             r.z = **layermod;
+            moved();
         }
 
         // Process triggers.
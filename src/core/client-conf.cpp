@@ -42,8 +42,11 @@ bool Conf::fullscreen = false;
 int Conf::musicVolume = 100;
 int Conf::soundVolume = 100;
 time_t Conf::cacheTTL = 300;
+size_t Conf::cacheBudget = 0;
 int Conf::persistInit = 0;
 int Conf::persistCons = 0;
+String Conf::resourceTracePath;
+bool Conf::verifyResources = false;
 
 // Parse and process the client config file, and set configuration defaults for
 // missing options.
@@ -83,6 +86,12 @@ Conf::parse(StringView filename) noexcept {
                          "default");
             }
         }
+        if (engine->hasString("resourcetrace")) {
+            Conf::resourceTracePath = engine->stringAt("resourcetrace");
+        }
+        if (engine->hasBool("verifyresources")) {
+            Conf::verifyResources = engine->boolAt("verifyresources");
+        }
     }
 
     if (doc->hasObject("window")) {
@@ -114,7 +123,12 @@ Conf::parse(StringView filename) noexcept {
         Unique<JSONObject> cache = doc->objectAt("cache");
 
         if (cache->hasUnsigned("ttl")) {
-            Conf::cacheTTL = cache->unsignedAt("ttl") != 0;
+            Conf::cacheTTL = cache->unsignedAt("ttl");
+        }
+        if (cache->hasUnsigned("budget")) {
+            Conf::cacheBudget =
+                    static_cast<size_t>(cache->unsignedAt("budget")) * 1024 *
+                    1024;
         }
     }
 
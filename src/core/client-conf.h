@@ -32,6 +32,7 @@
 #include "core/vec.h"
 #include "util/int.h"
 #include "util/string-view.h"
+#include "util/string.h"
 
 //! Engine-wide user-confurable values.
 struct Conf {
@@ -45,9 +46,22 @@ struct Conf {
     static int musicVolume;
     static int soundVolume;
     static time_t cacheTTL;
+
+    //! Bytes each cache may hold before dropping unused items early, least
+    //! recently used first. Zero for no limit.
+    static size_t cacheBudget;
+
     static int persistInit;
     static int persistCons;
 
+    //! If set, append each resource path to this file the first time it is
+    //! loaded. Used by pack-tool to lay out archives in load order.
+    static String resourceTracePath;
+
+    //! If set, check each resource against its checksum the first time it is
+    //! loaded and refuse ones that do not match.
+    static bool verifyResources;
+
 	static bool parse(StringView filename) noexcept;
 };
 
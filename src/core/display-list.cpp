@@ -65,34 +65,115 @@ pushLetterbox(DisplayList* display, Function<void()> op) noexcept {
     GameWindow::clip(x, y, width, height, op);
 }
 
+// Past this many separate regions, redraw the whole screen.
+#define MAX_DIRTY_RECTS 8
+
+static bool
+overlaps(const DisplayRect& a, const DisplayRect& b) noexcept {
+    return a.x1 <= b.x2 && b.x1 <= a.x2 && a.y1 <= b.y2 && b.y1 <= a.y2;
+}
+
+// Joins dirty regions that touch so that no pixel is drawn twice.
+static void
+mergeDirtyRects(DisplayList* display) noexcept {
+    Vector<DisplayRect>& rects = display->dirtyRects;
+
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < rects.size(); i++) {
+            for (size_t j = i + 1; j < rects.size(); j++) {
+                if (overlaps(rects[i], rects[j])) {
+                    rects[i].x1 = min(rects[i].x1, rects[j].x1);
+                    rects[i].y1 = min(rects[i].y1, rects[j].y1);
+                    rects[i].x2 = max(rects[i].x2, rects[j].x2);
+                    rects[i].y2 = max(rects[i].y2, rects[j].y2);
+                    rects[j] = rects.back();
+                    rects.pop_back();
+                    merged = true;
+                    j--;
+                }
+            }
+        }
+    }
+
+    if (rects.size() > MAX_DIRTY_RECTS) {
+        display->fullRedraw = true;
+    }
+}
+
+// Scratch space for the items under one dirty region. Reused between frames.
+static Vector<DisplayItem> itemsInRect;
+
+// Fills itemsInRect with the items, in order, that cover part of `r`.
+static void
+findItemsInRect(const DisplayList* display, const DisplayRect& r) noexcept {
+    itemsInRect.clear();
+
+    for (const DisplayItem& item : display->items) {
+        float x1 = item.destination.x;
+        float y1 = item.destination.y;
+        float x2 = x1 + static_cast<float>(Image::width(item.image));
+        float y2 = y1 + static_cast<float>(Image::height(item.image));
+
+        if (x1 < r.x2 && r.x1 < x2 && y1 < r.y2 && r.y1 < y2) {
+            itemsInRect.push_back(item);
+        }
+    }
+}
+
 void
 displayListPresent(DisplayList* display) noexcept {
+    if (!display->fullRedraw) {
+        mergeDirtyRects(display);
+    }
+
+    float ww = static_cast<float>(GameWindow::width());
+    float wh = static_cast<float>(GameWindow::height());
+
+    auto drawItems = [&] {
+        Image::drawMany(display->items.data(), display->items.size());
+    };
+
+    auto drawColorOverlay = [&] {
+        if ((display->colorOverlayARGB & 0xFF000000) != 0) {
+            GameWindow::drawRect(0, ww, 0, wh, display->colorOverlayARGB);
+        }
+    };
+
     pushLetterbox(display, [&] {
         // Zoom and pan the Area to fit on-screen.
         GameWindow::translate(-display->padding.x, -display->padding.y, [&] {
             GameWindow::scale(display->scale.x, display->scale.y, [&] {
                 GameWindow::translate(
                         -display->scroll.x, -display->scroll.y, [&] {
-                    for (auto& item : display->items) {
-                        Image::draw(item.image,
-                                    item.destination.x,
-                                    item.destination.y,
-                                    0);
+                    if (display->fullRedraw) {
+                        drawItems();
+                        return;
+                    }
+
+                    // Paint each changed region over what was left there
+                    // last frame, submitting only the items under it.
+                    for (DisplayRect& r : display->dirtyRects) {
+                        findItemsInRect(display, r);
+                        GameWindow::clip(
+                                r.x1, r.y1, r.x2 - r.x1, r.y2 - r.y1, [&] {
+                            GameWindow::drawRect(0, ww, 0, wh, 0xFF000000);
+                            Image::drawMany(itemsInRect.data(),
+                                            itemsInRect.size());
+                            drawColorOverlay();
+                        });
                     }
                 });
             });
         });
 
-        if ((display->colorOverlayARGB & 0xFF000000) != 0) {
-            float ww = static_cast<float>(GameWindow::width());
-            float wh = static_cast<float>(GameWindow::height());
-            GameWindow::drawRect(0, ww, 0, wh, display->colorOverlayARGB);
+        if (display->fullRedraw) {
+            drawColorOverlay();
         }
     });
 
     if (display->paused) {
-        float ww = static_cast<float>(GameWindow::width());
-        float wh = static_cast<float>(GameWindow::height());
         GameWindow::drawRect(0, ww, 0, wh, 0x7F000000);
         ImageID pauseInfo = Images::load("resource/pause_overlay.png");
         if (pauseInfo) {
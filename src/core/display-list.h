@@ -36,18 +36,33 @@ struct DisplayItem {
     rvec2 destination;
 };
 
+// A region of the Area, in the same coordinates as item destinations.
+struct DisplayRect {
+    float x1, y1;
+    float x2, y2;
+};
+
 struct DisplayList {
+    // Counts calls to World::draw.
+    size_t frame = 0;
+
+    // If false, only the parts of the screen under dirtyRects have changed
+    // since the last frame and the rest may be kept.
+    bool fullRedraw = true;
+    Vector<DisplayRect> dirtyRects;
+
     bool loopX, loopY;
 
-    rvec2 padding;
-    rvec2 scale;
-    rvec2 scroll;
-    rvec2 size;
+    // Compared against by the next frame, so start with values.
+    rvec2 padding = {0, 0};
+    rvec2 scale = {0, 0};
+    rvec2 scroll = {0, 0};
+    rvec2 size = {0, 0};
 
     Vector<DisplayItem> items;
 
-    uint32_t colorOverlayARGB;
-    bool paused;  // TODO: Move to colorOverlay & overlay.
+    uint32_t colorOverlayARGB = 0;
+    bool paused = false;  // TODO: Move to colorOverlay & overlay.
 };
 
 void displayListPresent(DisplayList* display) noexcept;
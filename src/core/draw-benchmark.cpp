@@ -0,0 +1,100 @@
+/********************************
+** Tsunagari Tile Engine       **
+** draw-benchmark.cpp          **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#include "core/draw-benchmark.h"
+
+#include "core/display-list.h"
+#include "core/images.h"
+#include "core/log.h"
+#include "os/chrono.h"
+#include "util/int.h"
+#include "util/string-view.h"
+#include "util/string.h"
+#include "util/vector.h"
+
+#define SPRITE_SIZE 16
+#define SPRITES_PER_ROW 100
+#define FRAMES 100
+
+// Lays out one row after another so that no two sprites overlap, as
+// Image::drawOnto requires. Every other sprite comes from `odd`.
+static Vector<DisplayItem>
+makeScene(ImageID even, ImageID odd) noexcept {
+    Vector<DisplayItem> items;
+    items.reserve(SPRITES_PER_ROW * SPRITES_PER_ROW);
+
+    for (int y = 0; y < SPRITES_PER_ROW; y++) {
+        for (int x = 0; x < SPRITES_PER_ROW; x++) {
+            ImageID image = (x + y) % 2 == 0 ? even : odd;
+            rvec2 destination{static_cast<float>(x * SPRITE_SIZE),
+                              static_cast<float>(y * SPRITE_SIZE)};
+            items.push_back(DisplayItem{image, destination});
+        }
+    }
+
+    return items;
+}
+
+static void
+timeScene(StringView description,
+          ImageID canvas,
+          const Vector<DisplayItem>& items) noexcept {
+    TimePoint start = SteadyClock::now();
+    for (int frame = 0; frame < FRAMES; frame++) {
+        Image::drawOnto(canvas, items.data(), items.size());
+    }
+    TimePoint end = SteadyClock::now();
+
+    float msPerFrame = ns_to_s_d(end - start) * 1000.0f / FRAMES;
+    Log::info("DrawBenchmark",
+              String() << description << ": " << msPerFrame
+                       << " ms per frame of " << items.size() << " sprites");
+}
+
+void
+runDrawBenchmark() noexcept {
+    // Canvases are each their own texture, which lets the scene control how
+    // many sprites share one.
+    int canvasSize = SPRITES_PER_ROW * SPRITE_SIZE;
+    ImageID canvas = Images::makeCanvas(canvasSize, canvasSize);
+    ImageID a = Images::makeCanvas(SPRITE_SIZE, SPRITE_SIZE);
+    ImageID b = Images::makeCanvas(SPRITE_SIZE, SPRITE_SIZE);
+
+    if (!canvas || !a || !b) {
+        Log::err("DrawBenchmark", "Could not create canvases");
+    }
+    else {
+        // Sprites that share a texture can be submitted together, as when
+        // they are packed into one atlas page. Alternating textures forces
+        // a submission per sprite, as when every image is its own texture.
+        timeScene("One texture", canvas, makeScene(a, a));
+        timeScene("Alternating textures", canvas, makeScene(a, b));
+    }
+
+    Image::release(b);
+    Image::release(a);
+    Image::release(canvas);
+}
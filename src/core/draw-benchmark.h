@@ -1,7 +1,7 @@
 /********************************
 ** Tsunagari Tile Engine       **
-** resources.cpp               **
-** Copyright 2016 Paul Merrill **
+** draw-benchmark.h            **
+** Copyright 2019 Paul Merrill **
 ********************************/
 
 // **********
@@ -24,14 +24,11 @@
 // IN THE SOFTWARE.
 // **********
 
-#include <string>
+#ifndef SRC_CORE_DRAW_BENCHMARK_H_
+#define SRC_CORE_DRAW_BENCHMARK_H_
 
-#include "core/future-utils.cpp"
-#include "core/resources.h"
+// Times the image backend drawing a scene of many sprites and logs the
+// results. Run with `tsunagari --draw-benchmark`. Needs a window but no world.
+void runDrawBenchmark() noexcept;
 
-// Default implementation doesn't actually load asynchronously.
-std::future<Resource>
-Resources::loadAsync(ResourceLoadPriority /* unused */,
-                     const std::string& path) {
-    return makeFuture(load(path));
-}
+#endif  // SRC_CORE_DRAW_BENCHMARK_H_
@@ -53,6 +53,16 @@ static StringView directions[][3] = {
 };
 
 
+void
+Entity::releaseSprite() noexcept {
+    spriteSheets.release();
+}
+
+void
+Entity::reloadSprite() noexcept {
+    spriteSheets.reload();
+}
+
 bool
 Entity::init(StringView descriptor, StringView initialPhase) noexcept {
     this->descriptor = descriptor;
@@ -73,6 +83,7 @@ void
 Entity::draw(DisplayList* display) noexcept {
     redraw = false;
     if (!phase) {
+        undraw(display);
         return;
     }
 
@@ -87,8 +98,33 @@ Entity::draw(DisplayList* display) noexcept {
     float maxY = area->grid.tileDim.y + r.y;
     float minY = maxY - imgsz.y;
 
-    display->items.push_back(DisplayItem{phase->frame(now),
-                                         rvec2{minX, minY}});
+    ImageID image = phase->frame(now);
+    DisplayRect rect{minX, minY, maxX, maxY};
+
+    if (!drawn || image != drawnImage || rect.x1 != drawnRect.x1 ||
+        rect.y1 != drawnRect.y1 || rect.x2 != drawnRect.x2 ||
+        rect.y2 != drawnRect.y2) {
+        if (drawn) {
+            display->dirtyRects.push_back(drawnRect);
+        }
+        display->dirtyRects.push_back(rect);
+    }
+
+    drawn = true;
+    drawnFrame = display->frame;
+    drawnImage = image;
+    drawnRect = rect;
+
+    display->items.push_back(DisplayItem{image, rvec2{minX, minY}});
+}
+
+void
+Entity::undraw(DisplayList* display) noexcept {
+    if (!drawn || drawnFrame == display->frame) {
+        return;
+    }
+    display->dirtyRects.push_back(drawnRect);
+    drawn = false;
 }
 
 bool
@@ -142,6 +178,20 @@ Entity::tick(time_t dt) noexcept {
     }
 }
 
+Optional<time_t>
+Entity::nextWakeup(time_t now) const noexcept {
+    // Movement and script callbacks happen on every tick.
+    if (moving || !onTickFns.empty()) {
+        return Optional<time_t>(now);
+    }
+
+    if (phase && phase->isAnimated()) {
+        return Optional<time_t>(phase->nextFrameTime(now));
+    }
+
+    return none;
+}
+
 void
 Entity::turn() noexcept {
     for (auto& fn : onTurnFns) {
@@ -271,11 +321,19 @@ Entity::_setPhase(StringView name) noexcept {
     return PHASE_NOTCHANGED;
 }
 
+void
+Entity::moved() noexcept {
+    if (area) {
+        area->entityMoved(this);
+    }
+}
+
 void
 Entity::setDestinationCoordinate(rcoord destCoord) noexcept {
     // Set z right away so that we're on-level with the square we're
     // entering.
     r.z = destCoord.z;
+    moved();
 
     this->destCoord = destCoord;
     angleToDest = static_cast<float>(atan2(destCoord.y - r.y, destCoord.x - r.x));
@@ -295,10 +353,12 @@ Entity::moveTowardDestination(time_t dt) noexcept {
         // The destination has not been reached yet.
         r.x += static_cast<float>(cos(angleToDest)) * traveledPixels;
         r.y += static_cast<float>(sin(angleToDest)) * traveledPixels;
+        moved();
     }
     else {
         // We have arrived at the destination.
         r = destCoord;
+        moved();
         moving = false;
         arrived();
 
@@ -366,7 +426,7 @@ Entity::processSprite(Unique<JSONObject> sprite) noexcept {
     imgsz.x = sheet->intAt("tile_width");
     imgsz.y = sheet->intAt("tile_height");
     StringView path = sheet->stringAt("path");
-    TiledImageID tiles = Images::loadTiles(path, imgsz.x, imgsz.y);
+    TiledImageID tiles = spriteSheets.load(path, imgsz.x, imgsz.y);
     CHECK(tiles);
 
     return processPhases(sprite->objectAt("phases"), tiles);
@@ -413,8 +473,7 @@ Entity::processPhase(StringView name,
             Log::err(descriptor, "<phase> frame attribute index out of bounds");
             return false;
         }
-        ImageID image = TiledImage::getTile(tiles, frame);
-        phases[name] = Animation(image);
+        phases[name] = Animation(spriteSheets.getTile(tiles, frame));
     }
     else if (phase->hasArray("frames")) {
         if (!phase->hasFloat("speed")) {
@@ -433,7 +492,7 @@ Entity::processPhase(StringView name,
                          "<phase> frames attribute index out of bounds");
                 return false;
             }
-            images.push_back(TiledImage::getTile(tiles, i));
+            images.push_back(spriteSheets.getTile(tiles, i));
         }
 
         phases[name] = Animation(move_(images), (time_t)(1000.0 / fps));
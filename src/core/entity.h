@@ -29,17 +29,19 @@
 #define SRC_CORE_ENTITY_H_
 
 #include "core/animation.h"
+#include "core/display-list.h"
 #include "core/images.h"
 #include "core/jsons.h"
+#include "core/tile-sheets.h"
 #include "core/vec.h"
 #include "util/function.h"
 #include "util/hashtable.h"
+#include "util/optional.h"
 #include "util/string.h"
 #include "util/vector.h"
 
 class Animation;
 class Area;
-struct DisplayList;
 
 enum SetPhaseResult { PHASE_NOTFOUND, PHASE_NOTCHANGED, PHASE_CHANGED };
 
@@ -67,11 +69,24 @@ class Entity {
 
     void draw(DisplayList* display) noexcept;
     bool needsRedraw(const icube& visiblePixels) const noexcept;
+
+    // Marks where the Entity was last drawn as needing to be painted over,
+    // unless it has been drawn again this frame.
+    void undraw(DisplayList* display) noexcept;
     bool isDead() const noexcept;
 
+    // Let the image cache free the sprite sheet while the Entity's Area is
+    // out of focus. reloadSprite() loads it again before it is drawn.
+    void releaseSprite() noexcept;
+    void reloadSprite() noexcept;
+
     virtual void tick(time_t dt) noexcept;
     virtual void turn() noexcept;
 
+    // The earliest time at which the Entity will move or change frames, or
+    // none if it is standing still.
+    Optional<time_t> nextWakeup(time_t now) const noexcept;
+
     // Normalize each of the X-Y axes into [-1, 0, or 1] and saves value
     // to 'facing'.
     void setFacing(ivec2 facing) noexcept;
@@ -125,6 +140,9 @@ class Entity {
     // Precalculate various drawing measurements.
     void calcDraw() noexcept;
 
+    // Tell the Area that the position changed.
+    void moved() noexcept;
+
     // Gets a string describing a direction.
     StringView directionStr(ivec2 facing) const noexcept;
 
@@ -181,6 +199,21 @@ class Entity {
     float angleToDest;
 
     ivec2 imgsz;
+
+    // What was last drawn, and in which frame. See DisplayList::frame.
+    bool drawn = false;
+    size_t drawnFrame = 0;
+    ImageID drawnImage;
+    DisplayRect drawnRect;
+
+    // Where the Area keeps this Entity to find it for drawing, and its place
+    // in drawing order. Managed by Area.
+    int drawBucket = -1;
+    uint64_t drawOrder = 0;
+
+    // The sprite sheet and the tiles taken from it for phases.
+    TileSheets spriteSheets;
+
     Hashmap<String, Animation> phases;
     Animation* phase = nullptr;
     String phaseName = "";
@@ -192,6 +225,8 @@ class Entity {
 
     Vector<OnTickFn> onTickFns;
     Vector<OnTurnFn> onTurnFns;
+
+    friend Area;
 };
 
 #endif  // SRC_CORE_ENTITY_H_
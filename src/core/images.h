@@ -32,6 +32,8 @@
 #include "util/markable.h"
 #include "util/string-view.h"
 
+struct DisplayItem;
+
 typedef Markable<int,-1> TiledImageID;
 typedef Markable<int,-1> ImageID;
 
@@ -46,8 +48,16 @@ class Images {
                                   int tileWidth,
                                   int tileHeight) noexcept;
 
+    // Forget a cached image so the next load reads it again. Images already
+    // handed out are unaffected.
+    static void invalidate(StringView path) noexcept;
+
     // Free images not recently used.
     static void prune(time_t latestPermissibleUse) noexcept;
+
+    // Create a blank image that can be drawn onto with Image::drawOnto.
+    // Release it with Image::release.
+    static ImageID makeCanvas(int width, int height) noexcept;
 };
 
 class TiledImage {
@@ -56,6 +66,10 @@ class TiledImage {
 
     static ImageID getTile(TiledImageID tiid, int i) noexcept;
 
+    // Point a tile from getTile() at tile `i` of another TiledImage, such as
+    // the same file loaded again. If `tiid` is marked, the tile draws nothing.
+    static void resetTile(TiledImageID tiid, int i, ImageID tile) noexcept;
+
     static void release(TiledImageID tiid) noexcept;
 };
 
@@ -63,6 +77,16 @@ class Image {
  public:
     static void draw(ImageID iid, float x, float y, float z) noexcept;
 
+    // Draw many images in the order given. Backends may submit them to the
+    // GPU together.
+    static void drawMany(const DisplayItem* items, size_t count) noexcept;
+
+    // Replace the contents of a canvas with the given images, positioned
+    // relative to its top-left corner. The images must not overlap.
+    static void drawOnto(ImageID canvas,
+                         const DisplayItem* items,
+                         size_t count) noexcept;
+
     static int width(ImageID iid) noexcept;
     static int height(ImageID iid) noexcept;
 
@@ -42,6 +42,8 @@
 #include "rapidjson/document.h"
 #include "rapidjson/reader.h"
 
+#include <atomic>
+
 // Skip later headers that conflict with ones that rapidjson includes.
 // clang-format off
 #define SRC_OS_C_H_
@@ -52,8 +54,8 @@
 
 #include "core/jsons.h"
 
-#include "cache/rc-cache-impl.h"
-#include "cache/rc-reader-cache.h"
+#include "cache/cache-impl.h"
+#include "core/client-conf.h"
 #include "core/log.h"
 #include "core/measure.h"
 #include "core/resources.h"
@@ -157,7 +159,7 @@ class JSONDocImpl : public JSONObjectImpl {
     RJDocument document;
 };
 
-Rc<JSONObject> genJSON(StringView path) noexcept;
+Rc<JSONObject> genJSON(StringView path, size_t& cost) noexcept;
 
 Vector<StringView>
 JSONObjectImpl::names() noexcept {
@@ -375,13 +377,19 @@ JSONDocImpl::get() noexcept {
 }
 
 
+// `cost` is set to about how much memory the document uses.
 Rc<JSONObject>
-genJSON(StringView path) noexcept {
-    Optional<StringView> r = Resources::load(path);
+genJSON(StringView path, size_t& cost) noexcept {
+    cost = 0;
+
+    Optional<Resource> r = Resources::load(path);
     if (!r) {
         return Rc<JSONObject>();
     }
-    StringView json = *r;
+    StringView json = r->view();
+
+    // A copy of the text and the DOM built from it.
+    cost = json.size * 2;
 
     TimeMeasure m(String() << "Constructed " << path << " as json");
 
@@ -393,11 +401,81 @@ genJSON(StringView path) noexcept {
     return Rc<JSONObject>(new JSONDocImpl(move_(document)));
 }
 
-static RcReaderCache<Rc<JSONObject>, genJSON> documents;
+// Only touched by the main thread.
+static Cache<Rc<JSONObject>> documents("JSONs");
+
+// Documents parsed by loadAsync(), waiting to be moved into `documents` by the
+// main thread. Workers push onto the list and the main thread takes all of it
+// at once, so no lock is needed, and Rc reference counts are never touched by
+// two threads.
+struct PendingDocument {
+    String path;
+    Rc<JSONObject> doc;
+    size_t cost;
+    PendingDocument* next;
+};
+
+static std::atomic<PendingDocument*> pendingDocuments(nullptr);
+
+static void
+addPendingDocuments() noexcept {
+    PendingDocument* pending =
+            pendingDocuments.exchange(nullptr, std::memory_order_acquire);
+
+    while (pending) {
+        PendingDocument* next = pending->next;
+
+        // A synchronous load may have beaten the worker to it.
+        if (!documents.contains(pending->path)) {
+            documents.set(pending->path, move_(pending->doc), pending->cost);
+        }
+        delete pending;
+
+        pending = next;
+    }
+}
 
 Rc<JSONObject>
 JSONs::load(StringView path) noexcept {
-    return documents.lifetimeRequest(path);
+    addPendingDocuments();
+
+    CacheHandle handle = documents.acquire(path);
+    if (handle) {
+        return documents[*handle];
+    }
+
+    size_t cost;
+    Rc<JSONObject> doc = genJSON(path, cost);
+    documents.set(path, doc, cost);
+    return doc;
+}
+
+void
+JSONs::loadAsync(ResourceLoadPriority priority,
+                 StringView path,
+                 Function<void(JSONObject&)> onLoad) noexcept {
+    String path_ = path;
+
+    Resources::loadAsync(priority, path, [path_, onLoad](StringView) {
+        // The resource is in memory now, so this only parses it.
+        size_t cost;
+        Rc<JSONObject> doc = genJSON(path_, cost);
+        if (!doc) {
+            return;
+        }
+
+        if (onLoad) {
+            onLoad(*doc);
+        }
+
+        PendingDocument* pending =
+                new PendingDocument{path_, move_(doc), cost};
+        pending->next = pendingDocuments.load(std::memory_order_relaxed);
+        while (!pendingDocuments.compare_exchange_weak(
+                pending->next, pending, std::memory_order_release,
+                std::memory_order_relaxed)) {
+        }
+    });
 }
 
 Unique<JSONObject>
@@ -405,7 +483,14 @@ JSONs::parse(String data) noexcept {
     return Unique<JSONObject>(new JSONDocImpl(move_(data)));
 }
 
+void
+JSONs::invalidate(StringView path) noexcept {
+    addPendingDocuments();
+    documents.erase(path);
+}
+
 void
 JSONs::garbageCollect() noexcept {
-    documents.garbageCollect();
+    addPendingDocuments();
+    documents.garbageCollect(World::time() - Conf::cacheTTL * 1000);
 }
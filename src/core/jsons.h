@@ -27,6 +27,8 @@
 #ifndef SRC_CORE_JSONS_H_
 #define SRC_CORE_JSONS_H_
 
+#include "core/resources.h"
+#include "util/function.h"
 #include "util/rc.h"
 #include "util/string-view.h"
 #include "util/string.h"
@@ -91,12 +93,23 @@ class JSONArray {
 
 class JSONs {
  public:
-    //! Load a JSON document.
+    //! Load a JSON document. Call only from the main thread.
     static Rc<JSONObject> load(StringView path) noexcept;
 
+    //! Parse a document on a worker thread so a later load() finds it ready.
+    //! If set, `onLoad` is called on the worker with the document before
+    //! load() can see it, for example to start loading what it refers to.
+    static void loadAsync(ResourceLoadPriority priority,
+                          StringView path,
+                          Function<void(JSONObject&)> onLoad = {}) noexcept;
+
     //! Parse a document from the outside world.
     static Unique<JSONObject> parse(String data) noexcept;
 
+    //! Forget a cached document so the next load() reads it again. Documents
+    //! already handed out are unaffected.
+    static void invalidate(StringView path) noexcept;
+
     //! Free JSON documents not recently used.
     static void garbageCollect() noexcept;
 };
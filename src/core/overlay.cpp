@@ -39,6 +39,7 @@ Overlay::tick(time_t dt) noexcept {
 void
 Overlay::teleport(vicoord coord) noexcept {
     r = area->grid.virt2virt(coord);
+    moved();
     redraw = true;
 }
 
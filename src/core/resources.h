@@ -28,16 +28,75 @@
 #ifndef SRC_CORE_RESOURCES_H_
 #define SRC_CORE_RESOURCES_H_
 
+#include "util/function.h"
+#include "util/int.h"
 #include "util/noexcept.h"
 #include "util/optional.h"
 #include "util/string-view.h"
+#include "util/string.h"
+#include "util/vector.h"
+
+// How soon an asynchronously loaded resource is needed.
+enum ResourceLoadPriority {
+    RESOURCE_LOAD_NOW,          // Needed this frame.
+    RESOURCE_LOAD_NEXT_AREA,    // Needed when the player changes areas.
+    RESOURCE_LOAD_SPECULATIVE,  // Might be needed at some point.
+};
+
+// The contents of a loaded resource, which stay in memory while the Resource
+// exists.
+class Resource {
+ public:
+    Resource(StringView data, int cacheHandle) noexcept;
+    Resource(Resource&& other) noexcept;
+    Resource(const Resource&) = delete;
+    ~Resource() noexcept;
+
+    Resource& operator=(Resource&& other) noexcept;
+
+    StringView view() const noexcept { return data_; }
+    const char* data() const noexcept { return data_.data; }
+    size_t size() const noexcept { return data_.size; }
+
+ private:
+    StringView data_;
+    int cacheHandle;  // -1 if the data is not cached.
+};
 
 // Provides data and resource extraction for a World.
-// Each World comes bundled with associated data.
+// Each World comes bundled with associated data. Safe to use from several
+// threads at once.
 class Resources {
  public:
-    // Load a resource from the file at the given path.
-    static Optional<StringView> load(StringView path) noexcept;
+    // Load a resource from the file at the given path. Resources read into
+    // memory, such as blobs decompressed from an archive, are cached and
+    // charged to Conf::cacheBudget. Hold on to the Resource only while its
+    // data is needed so the cache can free it.
+    static Optional<Resource> load(StringView path) noexcept;
+
+    // Load a resource on a worker thread and pass its data to `onLoad` there,
+    // if set. Later calls to load() with the same path will not wait on the
+    // disk or decompress it again unless the cache has freed it.
+    static void loadAsync(ResourceLoadPriority priority,
+                          StringView path,
+                          Function<void(StringView)> onLoad = {}) noexcept;
+
+    // Start reading resources from disk that will be loaded soon. Missing
+    // paths are ignored.
+    static void prefetch(Vector<StringView> paths) noexcept;
+
+    // Paths of resources that changed since the last call. Later loads of
+    // them return the new contents. Always empty when reading from an
+    // archive. Only called from the main thread.
+    static Vector<String> changedPaths() noexcept;
+
+    // Whether changedPaths() can find anything, so it is worth calling even
+    // while the game is idle.
+    static bool watchingForChanges() noexcept;
+
+    // Free cached resources no longer held and not loaded since before
+    // `latestPermissibleUse`.
+    static void prune(time_t latestPermissibleUse) noexcept;
 };
 
 #endif  // SRC_CORE_RESOURCES_H_
@@ -39,6 +39,10 @@ class Sounds {
  public:
     static SoundID load(StringView path) noexcept;
 
+    // Forget a cached sound so the next load reads it again. Sounds already
+    // handed out are unaffected.
+    static void invalidate(StringView path) noexcept;
+
     // Free destroyed Sounds that were not recently played.
     static void prune(time_t latestPermissibleUse) noexcept;
 };
@@ -73,6 +73,24 @@ TileGrid::setTileType(vicoord virt, int type) noexcept {
 
     int idx = (phys.z * dim.y + phys.y) * dim.x + phys.x;
     graphics[idx] = type;
+
+    if (!dirtyChunks.empty()) {
+        dirtyChunks[chunkIndex(phys)] = true;
+    }
+    tilesChanged = true;
+}
+
+ivec2
+TileGrid::chunkDim() const noexcept {
+    return ivec2{(dim.x + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE,
+                 (dim.y + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE};
+}
+
+int
+TileGrid::chunkIndex(icoord phys) const noexcept {
+    ivec2 chunks = chunkDim();
+    return (phys.z * chunks.y + phys.y / TILE_CHUNK_SIZE) * chunks.x +
+           phys.x / TILE_CHUNK_SIZE;
 }
 
 bool
@@ -96,6 +96,10 @@ struct Exit {
 
 typedef void (*TileScript)(Entity& triggeredBy, icoord tile);
 
+// Tile layers are drawn in squares of this many tiles on a side, which are
+// cached between frames. See Area::drawTiles().
+#define TILE_CHUNK_SIZE 16
+
 class TileGrid {
  public:
     int getTileType(icoord phys) noexcept;
@@ -120,6 +124,12 @@ class TileGrid {
     rcoord virt2virt(vicoord virt) const noexcept;
     vicoord virt2virt(rcoord virt) const noexcept;
 
+    // Number of chunks across and down each layer.
+    ivec2 chunkDim() const noexcept;
+
+    // Index of the chunk containing a tile.
+    int chunkIndex(icoord phys) const noexcept;
+
     // Convert between virtual and physical map depths.
     int depthIndex(float depth) const noexcept;
     float indexDepth(int idx) const noexcept;
@@ -141,6 +151,13 @@ class TileGrid {
     // 3-dimensional array of the tiles that make up the grid.
     Vector<int> graphics;
 
+    // Set for a chunk when one of its tiles changes, so that its cached
+    // drawing is thrown away. Empty until the Area has finished loading.
+    Vector<bool> dirtyChunks;
+
+    // Set when any tile changes, until the next time the grid is drawn.
+    bool tilesChanged = false;
+
     enum LayerType {
         TILE_LAYER,
         OBJECT_LAYER,
@@ -0,0 +1,108 @@
+/********************************
+** Tsunagari Tile Engine       **
+** tile-sheets.cpp             **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#include "core/tile-sheets.h"
+
+#include "util/assert.h"
+
+TileSheets::~TileSheets() noexcept {
+    for (Tile& tile : tiles) {
+        Image::release(tile.image);
+    }
+    // Sheets already released are marked, and releasing them does nothing.
+    for (Sheet& sheet : sheets) {
+        TiledImage::release(sheet.images);
+    }
+}
+
+TiledImageID
+TileSheets::load(StringView path, int tileWidth, int tileHeight) noexcept {
+    assert_(!released_);
+
+    TiledImageID images = Images::loadTiles(path, tileWidth, tileHeight);
+    if (images) {
+        sheets.push_back(Sheet{path, tileWidth, tileHeight, images});
+    }
+    return images;
+}
+
+ImageID
+TileSheets::getTile(TiledImageID images, int i) noexcept {
+    assert_(!released_);
+
+    // Owners take tiles from the sheet they loaded last, so look there first.
+    size_t sheet = sheets.size();
+    do {
+        assert_(sheet > 0);
+        sheet--;
+    } while (sheets[sheet].images != images);
+
+    ImageID image = TiledImage::getTile(images, i);
+    tiles.push_back(Tile{image, sheet, i});
+    return image;
+}
+
+void
+TileSheets::release() noexcept {
+    if (released_) {
+        return;
+    }
+    released_ = true;
+
+    for (Sheet& sheet : sheets) {
+        TiledImage::release(sheet.images);
+        sheet.images = mark;
+    }
+}
+
+void
+TileSheets::reload() noexcept {
+    if (!released_) {
+        return;
+    }
+    released_ = false;
+
+    for (Sheet& sheet : sheets) {
+        sheet.images = Images::loadTiles(
+                sheet.path, sheet.tileWidth, sheet.tileHeight);
+    }
+
+    // A sheet that has since changed may hold fewer tiles.
+    for (Tile& tile : tiles) {
+        TiledImageID images = sheets[tile.sheet].images;
+        if (images && tile.index < TiledImage::size(images)) {
+            TiledImage::resetTile(images, tile.index, tile.image);
+        }
+        else {
+            TiledImage::resetTile(mark, 0, tile.image);
+        }
+    }
+}
+
+bool
+TileSheets::released() const noexcept {
+    return released_;
+}
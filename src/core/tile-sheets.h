@@ -0,0 +1,81 @@
+/********************************
+** Tsunagari Tile Engine       **
+** tile-sheets.h               **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#ifndef SRC_CORE_TILE_SHEETS_H_
+#define SRC_CORE_TILE_SHEETS_H_
+
+#include "core/images.h"
+#include "util/int.h"
+#include "util/string-view.h"
+#include "util/string.h"
+#include "util/vector.h"
+
+// The tiled images an Area or Entity loads and the tiles it takes from them.
+// The sheets can be released while their owner is out of sight, letting the
+// image cache free them, and loaded again later. Tiles keep their ImageIDs
+// across a release and reload, so Animations holding them need not change.
+class TileSheets {
+ public:
+    TileSheets() = default;
+    TileSheets(const TileSheets&) = delete;
+    ~TileSheets() noexcept;
+
+    TiledImageID load(StringView path,
+                      int tileWidth,
+                      int tileHeight) noexcept;
+
+    // Take tile `i` from a sheet returned by load().
+    ImageID getTile(TiledImageID sheet, int i) noexcept;
+
+    // Give up the sheets. Tiles must not be drawn until reload().
+    void release() noexcept;
+
+    // Load the sheets again if they were released. Tiles whose sheet can no
+    // longer be loaded draw nothing.
+    void reload() noexcept;
+
+    bool released() const noexcept;
+
+ private:
+    struct Sheet {
+        String path;
+        int tileWidth;
+        int tileHeight;
+        TiledImageID images;
+    };
+
+    struct Tile {
+        ImageID image;
+        size_t sheet;
+        int index;
+    };
+
+    Vector<Sheet> sheets;
+    Vector<Tile> tiles;
+    bool released_ = false;
+};
+
+#endif  // SRC_CORE_TILE_SHEETS_H_
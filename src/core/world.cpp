@@ -48,6 +48,8 @@
 #include "util/bitrecord.h"
 #include "util/function.h"
 #include "util/hashtable.h"
+#include "util/math2.h"
+#include "util/optional.h"
 #include "util/rc.h"
 #include "util/unique.h"
 #include "util/vector.h"
@@ -60,6 +62,10 @@ class Player;
 static Rc<Image> pauseInfo;
 
 static Hashmap<String, Area*> areas;
+
+// Areas we have started loading in the background. Cleared when unused
+// documents are collected, in case theirs were among them.
+static Hashset<String> preloadedAreas;
 static Area* area = nullptr;
 static Unique<Player> player = new Player;
 
@@ -73,6 +79,28 @@ static time_t lastTime = 0;
  */
 static time_t total = 0;
 
+/**
+ * Unpaused game time at which caches were last pruned. See
+ * World::garbageCollect().
+ */
+static time_t lastGarbageCollection = 0;
+
+/**
+ * How often, in milliseconds of unpaused game time, to prune caches.
+ */
+static const time_t GARBAGE_COLLECTION_PERIOD = 10 * 1000;
+
+/**
+ * Longest time, in milliseconds, to go without a tick while idle.
+ */
+static const time_t MAX_IDLE_PERIOD = 60 * 60 * 1000;
+
+/**
+ * Longest time, in milliseconds, to go without a tick while idle if resources
+ * are being watched for changes, so that edits are still noticed.
+ */
+static const time_t RESOURCE_POLL_PERIOD = 250;
+
 static bool alive = false;
 static bool redraw = false;
 static bool userPaused = false;
@@ -147,15 +175,31 @@ void
 World::draw(DisplayList* display) noexcept {
     // TimeMeasure m("Drew world");
 
+    rvec2 padding = Viewport::getLetterboxOffset();
+    rvec2 scale = Viewport::getScale();
+    rvec2 scroll = Viewport::getMapOffset();
+    rvec2 size = Viewport::getPhysRes();
+
+    // Anything that moves the whole picture, or covers it, means every pixel
+    // must be drawn again.
+    display->fullRedraw = redraw || paused > 0 || display->paused ||
+                          display->padding != padding ||
+                          display->scale != scale ||
+                          display->scroll != scroll ||
+                          display->size != size ||
+                          display->colorOverlayARGB != area->getColorOverlay();
+    display->dirtyRects.clear();
+    display->frame += 1;
+
     redraw = false;
 
     display->loopX = area->grid.loopX;
     display->loopY = area->grid.loopY;
 
-    display->padding = Viewport::getLetterboxOffset();
-    display->scale = Viewport::getScale();
-    display->scroll = Viewport::getMapOffset();
-    display->size = Viewport::getPhysRes();
+    display->padding = padding;
+    display->scale = scale;
+    display->scroll = scroll;
+    display->size = size;
 
     display->colorOverlayARGB = area->getColorOverlay();
     display->paused = paused > 0;
@@ -168,8 +212,102 @@ World::needsRedraw() noexcept {
     return redraw || (!paused && area->needsRedraw());
 }
 
+time_t
+World::timeUntilWakeup() noexcept {
+    if (redraw) {
+        return 0;
+    }
+
+    time_t longest = Resources::watchingForChanges() ? RESOURCE_POLL_PERIOD
+                                                     : MAX_IDLE_PERIOD;
+
+    // Paused game time stands still, so only resources are checked.
+    if (paused) {
+        return longest;
+    }
+
+    // Caches are pruned from tick().
+    time_t wakeup = lastGarbageCollection + GARBAGE_COLLECTION_PERIOD;
+
+    Optional<time_t> areaWakeup = area->nextWakeup();
+    if (areaWakeup && *areaWakeup < wakeup) {
+        wakeup = *areaWakeup;
+    }
+
+    return bound(wakeup - total, time_t(0), longest);
+}
+
+// Free an area that is no longer cached or in focus.
+static void
+destroyArea(Area* old) noexcept {
+    DataArea* dataArea = old->getDataArea();
+    if (dataArea && dataArea->area == old) {
+        dataArea->area = nullptr;
+    }
+    delete old;
+}
+
+// Pick up resources edited while the game runs. Cached areas are built again
+// when next entered, and the current one right away.
+static void
+reloadChangedResources() noexcept {
+    Vector<String> paths = Resources::changedPaths();
+    if (paths.empty()) {
+        return;
+    }
+
+    for (String& path : paths) {
+        Log::info("World", String() << path << ": changed");
+
+        JSONs::invalidate(path);
+        Images::invalidate(path);
+        Sounds::invalidate(path);
+    }
+
+    String descriptor;
+    bool found = false;
+    Vector<Area*> oldAreas;
+    for (auto it = areas.begin(); it != areas.end(); it++) {
+        if (it.value() == area) {
+            descriptor = it.key();
+            found = true;
+        }
+        oldAreas.push_back(it.value());
+    }
+
+    if (!found) {
+        Log::err("World", "could not reload, current area is not cached");
+        redraw = true;
+        return;
+    }
+
+    Area* oldArea = area;
+
+    areas.clear();
+    preloadedAreas.clear();
+
+    if (!World::focusArea(descriptor, player->getTileCoords_vi())) {
+        Log::err("World",
+                 String() << descriptor << ": could not reload, keeping the "
+                                           "old version");
+        areas[descriptor] = oldArea;
+    }
+
+    // Nothing points at the old areas anymore, save for the one still in
+    // focus if it could not be reloaded.
+    for (Area* old : oldAreas) {
+        if (old != area) {
+            destroyArea(old);
+        }
+    }
+
+    redraw = true;
+}
+
 void
 World::tick(time_t dt) noexcept {
+    reloadChangedResources();
+
     if (paused) {
         return;
     }
@@ -177,6 +315,11 @@ World::tick(time_t dt) noexcept {
     total += dt;
 
     area->tick(dt);
+
+    if (total - lastGarbageCollection >= GARBAGE_COLLECTION_PERIOD) {
+        lastGarbageCollection = total;
+        garbageCollect();
+    }
 }
 
 void
@@ -201,11 +344,13 @@ World::focusArea(StringView filename, vicoord playerPos) noexcept {
     }
 
     if (!newArea->ok) {
+        delete newArea;
         return false;
     }
 
     DataArea* dataArea = DataWorld::instance().area(filename);
     if (!dataArea) {
+        delete newArea;
         return false;
     }
 
@@ -219,12 +364,47 @@ World::focusArea(StringView filename, vicoord playerPos) noexcept {
     return true;
 }
 
+// Start loading the areas the player can walk to from this one, so taking an
+// exit doesn't stall on reading and parsing them.
+static void
+preloadExits(Area* area) noexcept {
+    for (auto& exits : area->grid.exits) {
+        for (auto it = exits.begin(); it != exits.end(); it++) {
+            String& destination = it.value().area;
+
+            if (areas.contains(destination)) {
+                continue;
+            }
+            if (!preloadedAreas.insert(destination)) {
+                continue;
+            }
+
+            preloadAreaFromJSON(destination);
+        }
+    }
+}
+
 void
 World::focusArea(Area* area_, vicoord playerPos) noexcept {
+    if (area && area != area_) {
+        area->unfocus();
+        area->leftAt = total;
+    }
+
     area = area_;
     player->setArea(area, playerPos);
     Viewport::setArea(area);
     area->focus();
+
+    preloadExits(area);
+}
+
+void
+World::canvasesLost() noexcept {
+    if (area) {
+        area->releaseChunks();
+    }
+    redraw = true;
 }
 
 void
@@ -286,8 +466,20 @@ void
 World::garbageCollect() noexcept {
     time_t latestPermissibleUse = total - Conf::cacheTTL * 1000;
 
+    // Areas left behind for a while keep their tiles, entities, and script
+    // state, but let go of their images so they can be pruned. They are
+    // loaded again if the Area is entered.
+    for (auto it = areas.begin(); it != areas.end(); it++) {
+        Area* cached = it.value();
+        if (cached != area && cached->leftAt < latestPermissibleUse) {
+            cached->releaseImages();
+        }
+    }
+
     Images::prune(latestPermissibleUse);
     JSONs::garbageCollect();
+    preloadedAreas.clear();
     Music::garbageCollect();
     Sounds::prune(latestPermissibleUse);
+    Resources::prune(latestPermissibleUse);
 }
@@ -71,6 +71,13 @@ class World {
      */
     static bool needsRedraw() noexcept;
 
+    /**
+     * How long, in milliseconds, until a tick could change anything, if no
+     * input arrives in the meantime. Zero if the next frame should be ticked
+     * as usual.
+     */
+    static time_t timeUntilWakeup() noexcept;
+
     /**
      * Updates the game state within this World as if dt milliseconds had
      * passed since the last call.
@@ -101,6 +108,12 @@ class World {
     static bool focusArea(StringView filename, vicoord playerPos) noexcept;
     static void focusArea(Area* area, vicoord playerPos) noexcept;
 
+    /**
+     * The contents of canvases made with Images::makeCanvas were lost, for
+     * example because the renderer was reset. Draw them again.
+     */
+    static void canvasesLost() noexcept;
+
     static void setPaused(bool b) noexcept;
 
     static void storeKeys() noexcept;
@@ -44,6 +44,11 @@ DataArea::onTick(time_t) noexcept {}
 void
 DataArea::onTurn() noexcept {}
 
+bool
+DataArea::wantsTick() const noexcept {
+    return false;
+}
+
 void
 DataArea::tick(time_t dt) noexcept {
     // Only iterate over inProgresses that existed at the time of the
@@ -63,6 +68,22 @@ DataArea::turn() noexcept {
     onTurn();
 }
 
+Optional<time_t>
+DataArea::nextWakeup(time_t now) noexcept {
+    if (wantsTick()) {
+        return Optional<time_t>(now);
+    }
+
+    Optional<time_t> wakeup;
+    for (auto& inProgress : inProgresses) {
+        Optional<time_t> next = inProgress->nextWakeup(now);
+        if (next && (!wakeup || *next < *wakeup)) {
+            wakeup = next;
+        }
+    }
+    return wakeup;
+}
+
 void
 DataArea::playSoundEffect(StringView sound) noexcept {
     SoundID sid = Sounds::load(sound);
@@ -32,6 +32,7 @@
 #include "data/inprogress.h"
 #include "util/hashtable.h"
 #include "util/int.h"
+#include "util/optional.h"
 #include "util/string-view.h"
 #include "util/unique.h"
 #include "util/vector.h"
@@ -54,6 +55,11 @@ class DataArea {
     virtual void onTick(time_t dt) noexcept;
     virtual void onTurn() noexcept;
 
+    //! Whether onTick() must run every frame. False by default, so that
+    //! areas can go without ticks while idle. Scripts that override onTick()
+    //! should override this to return true.
+    virtual bool wantsTick() const noexcept;
+
     // For scripts
 
     //! Play a sound with a 3% speed variation applied to it.
@@ -65,6 +71,10 @@ class DataArea {
     void tick(time_t dt) noexcept;
     void turn() noexcept;
 
+    //! The earliest time at which tick() has anything to do, or none if
+    //! nothing is scheduled.
+    Optional<time_t> nextWakeup(time_t now) noexcept;
+
     Hashmap<StringView, TileScript> scripts;
 
  private:
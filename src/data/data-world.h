@@ -33,6 +33,7 @@
 #include "util/hashtable.h"
 #include "util/string-view.h"
 #include "util/unique.h"
+#include "util/vector.h"
 
 class DataWorld {
  public:
@@ -68,6 +69,10 @@ class DataWorld {
     } parameters;
     StringView datafile;
 
+    // Archives mounted over the datafile, oldest first. A path found in a
+    // later archive hides the same path in the datafile and earlier patches.
+    Vector<StringView> patchfiles;
+
  protected:
     DataWorld() = default;
 
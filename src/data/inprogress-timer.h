@@ -53,6 +53,7 @@ class InProgressTimer : public InProgress {
     InProgressTimer(time_t duration, ProgressFn progress, ThenFn then) noexcept;
 
     void tick(time_t dt) noexcept;
+    Optional<time_t> nextWakeup(time_t now) noexcept;
 
  private:
     time_t duration, passed;
@@ -37,6 +37,11 @@ InProgress::isOver() noexcept {
     return over;
 }
 
+Optional<time_t>
+InProgress::nextWakeup(time_t now) noexcept {
+    return Optional<time_t>(now);
+}
+
 
 InProgressSound::InProgressSound(StringView sound, ThenFn then) noexcept
         : then(then) {
@@ -100,3 +105,17 @@ InProgressTimer::tick(time_t dt) noexcept {
         }
     }
 }
+
+Optional<time_t>
+InProgressTimer::nextWakeup(time_t now) noexcept {
+    if (over) {
+        return none;
+    }
+
+    // Progress is reported on every tick.
+    if (progress) {
+        return Optional<time_t>(now);
+    }
+
+    return Optional<time_t>(now + duration - passed);
+}
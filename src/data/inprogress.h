@@ -30,6 +30,7 @@
 
 #include "util/int.h"
 #include "util/noexcept.h"
+#include "util/optional.h"
 
 /**
  * InProgress objects contain logic that is to be evaluated over time from
@@ -57,6 +58,10 @@ class InProgress {
     virtual void tick(time_t dt) noexcept = 0;
     bool isOver() noexcept;
 
+    // The earliest time at which tick() has anything to do, or none if it is
+    // waiting on nothing. By default, every tick is needed.
+    virtual Optional<time_t> nextWakeup(time_t now) noexcept;
+
  protected:
     InProgress() noexcept = default;
 
@@ -27,6 +27,7 @@
 
 #include "config.h"
 #include "core/client-conf.h"
+#include "core/draw-benchmark.h"
 #include "core/log.h"
 #include "core/measure.h"
 #include "core/resources.h"
@@ -35,6 +36,8 @@
 #include "data/data-world.h"
 #include "os/c.h"
 #include "util/int.h"
+#include "util/jobs.h"
+#include "util/string-view.h"
 
 #ifdef _WIN32
 #include "os/windows.h"
@@ -49,9 +52,12 @@
  *
  * The client config tells us our window parameters along with which World
  * we're going to load. The GameWindow class then loads and plays the game.
+ *
+ * With --draw-benchmark, times drawing instead and exits without loading a
+ * World.
  */
 int
-main() noexcept {
+main(int argc, char** argv) noexcept {
 #if defined(_WIN32) && !defined(NDEBUG)
     wFixConsole();
 #endif
@@ -77,6 +83,11 @@ main() noexcept {
         GameWindow::create();
     }
 
+    if (argc > 1 && StringView(argv[1]) == "--draw-benchmark") {
+        runDrawBenchmark();
+        return 0;
+    }
+
     DataWorld& dataWorld = DataWorld::instance();
 
     {
@@ -96,12 +107,16 @@ main() noexcept {
 
     GameWindow::mainLoop();
 
+    // Let background loads finish and stop the worker threads.
+    JobsFlush();
+
     return 0;
 }
 
 #ifdef _WIN32
 int __stdcall
 WinMain(void*, void*, void*, int) {
-    return main();
+    // GUI builds take no command line flags.
+    return main(0, nullptr);
 }
 #endif
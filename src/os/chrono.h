@@ -48,6 +48,10 @@ constexpr Duration
 s_to_ns(Duration d) {
     return d * 1000000000;
 }
+constexpr Duration
+ms_to_ns(Duration d) {
+    return d * 1000000;
+}
 constexpr float
 ms_to_s_d(Duration d) {
     return d / 1000.0f;
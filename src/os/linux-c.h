@@ -81,14 +81,36 @@ extern "C" {
 int open(const char*, int, ...) noexcept;
 #define O_RDONLY 00
 #define O_WRONLY 01
+#define O_RDWR 02
+#define O_APPEND 02000
 #define O_CREAT 0100
 #define O_TRUNC 01000
 }
 
+// sys/inotify.h
+extern "C" {
+struct inotify_event {
+    int wd;
+    uint32_t mask;
+    uint32_t cookie;
+    uint32_t len;
+    char name[];
+};
+int inotify_add_watch(int, const char*, uint32_t) noexcept;
+int inotify_init1(int) noexcept;
+#define IN_CLOSE_WRITE 0x00000008
+#define IN_MOVED_TO 0x00000080
+#define IN_CREATE 0x00000100
+#define IN_ISDIR 0x40000000
+#define IN_NONBLOCK 04000
+}
+
 // sys/mman.h
 extern "C" {
 void* mmap(void*, size_t, int, int, int, off_t) noexcept;
+int madvise(void*, size_t, int) noexcept;
 int munmap(void*, size_t) noexcept;
+#define MADV_WILLNEED 3
 #define MAP_FAILED ((void*)-1)
 #define MAP_SHARED 0x01
 #define PROT_READ 1
@@ -177,6 +199,7 @@ FILE* fopen(const char*, const char*) noexcept;
 int fprintf(FILE*, const char*, ...) noexcept;
 size_t fread(void*, size_t, size_t, FILE*) noexcept;
 int printf(const char*, ...) noexcept;
+int rename(const char*, const char*) noexcept;
 int sprintf(char*, const char*, ...) noexcept;
 extern FILE* const stdin;
 extern FILE* const stdout;
@@ -201,6 +224,7 @@ unsigned long strtoul(const char*, char**, int) noexcept;
 extern "C" {
 void* memchr(const void*, int, size_t) noexcept;
 int memcmp(const void*, const void*, size_t) noexcept;
+void* memcpy(void*, const void*, size_t) noexcept;
 void* memmem(const void*, size_t, const void*, size_t) noexcept;
 size_t strlen(char const*) noexcept;
 }
@@ -216,10 +240,15 @@ time_t time(time_t*) noexcept;
 // unistd.h
 extern "C" {
 int close(int) noexcept;
+int getpagesize() noexcept;
 int isatty(int) noexcept;
+off_t lseek(int, off_t, int) noexcept;
+ssize_t pread(int, void*, size_t, off_t) noexcept;
+ssize_t read(int, void*, size_t) noexcept;
 long sysconf(int) noexcept;
 ssize_t write(int, const void*, size_t) noexcept;
 #define _SC_NPROCESSORS_ONLN 84
+#define SEEK_SET 0
 }
 
 #endif  // SRC_OS_LINUX_C_H_
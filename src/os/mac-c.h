@@ -98,6 +98,8 @@ extern "C" {
 int open(const char*, int, ...) noexcept;
 #define O_RDONLY 0x0000
 #define O_WRONLY 0x0001
+#define O_RDWR 0x0002
+#define O_APPEND 0x0008
 #define O_CREAT 0x0200
 #define O_TRUNC 0x0400
 }
@@ -105,7 +107,9 @@ int open(const char*, int, ...) noexcept;
 // sys/mman.h
 extern "C" {
 void* mmap(void*, size_t, int, int, int, off_t) noexcept;
+int madvise(void*, size_t, int) noexcept;
 int munmap(void*, size_t) noexcept;
+#define MADV_WILLNEED 3
 #define MAP_FAILED ((void*)-1)
 #define MAP_SHARED 0x0001
 #define PROT_READ 0x01
@@ -225,6 +229,7 @@ FILE* fopen(const char*, const char*) noexcept;
 int fprintf(FILE*, const char*, ...) noexcept;
 size_t fread(void*, size_t, size_t, FILE*) noexcept;
 int printf(const char*, ...) noexcept;
+int rename(const char*, const char*) noexcept;
 int sprintf(char*, const char*, ...) noexcept;
 extern FILE* __stdinp;
 extern FILE* __stdoutp;
@@ -267,8 +272,12 @@ time_t time(time_t*) noexcept;
 // unistd.h
 extern "C" {
 int close(int) noexcept;
+int getpagesize() noexcept;
 int isatty(int) noexcept;
+off_t lseek(int, off_t, int) noexcept;
+ssize_t pread(int, void*, size_t, off_t) noexcept;
 ssize_t write(int, const void*, size_t) noexcept;
+#define SEEK_SET 0
 }
 
 #endif  // SRC_OS_MAC_C_H_
@@ -39,17 +39,29 @@ extern const char dirSeparator;
 
 typedef Markable<uint64_t, UINT64_MAX> Filesize;
 
+// Only meaningful when compared with other Filetimes.
+typedef Markable<uint64_t, UINT64_MAX> Filetime;
+
 Filesize getFileSize(StringView path) noexcept;
-bool writeFile(StringView path, uint32_t length, void* data) noexcept;
-bool writeFileVec(StringView path,
-                  uint32_t count,
-                  uint32_t* lengths,
-                  void** datas) noexcept;
+Filetime getFileModifiedTime(StringView path) noexcept;
+bool writeFile(StringView path, size_t length, void* data) noexcept;
+bool appendFile(StringView path, size_t length, const void* data) noexcept;
+bool renameFile(StringView from, StringView to) noexcept;
 bool isDir(StringView path) noexcept;
 void makeDirectory(StringView path) noexcept;
 Vector<String> listDir(StringView path) noexcept;
 Optional<String> readFile(StringView path) noexcept;
 
+// Start watching a directory tree for files that are written or moved into
+// it. Only one tree can be watched at a time. Returns false where this is not
+// supported, which is everywhere but Linux.
+bool watchDirectory(StringView path) noexcept;
+
+// Paths, relative to the watched directory and separated by '/', of files
+// changed since the last call. Does not block. Not thread-safe: call this and
+// watchDirectory() from the same thread.
+Vector<String> takeChangedFiles() noexcept;
+
 enum TermColor {
     TC_RESET,
     TC_GREEN,
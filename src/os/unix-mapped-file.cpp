@@ -51,12 +51,13 @@ MappedFile::fromPath(String& path) noexcept {
                                              0));
     size_t len = static_cast<size_t>(st.st_size);
 
+    // The mapping stays valid without the descriptor.
+    close(fd);
+
     if (map == MAP_FAILED) {
-        close(fd);
         return Optional<MappedFile>();
     }
 
-    // FIXME: Close the fd now or at destruction?
     return Optional<MappedFile>(MappedFile(map, len));
 }
 
@@ -80,6 +81,22 @@ MappedFile::~MappedFile() noexcept {
     }
 }
 
+void
+MappedFile::prefetch(size_t offset, size_t size) const noexcept {
+    if (map == MAP_FAILED || size == 0 || offset >= len) {
+        return;
+    }
+    if (size > len - offset) {
+        size = len - offset;
+    }
+
+    // madvise wants a page-aligned address.
+    size_t pageSize = static_cast<size_t>(getpagesize());
+    size_t begin = offset & ~(pageSize - 1);
+
+    madvise(map + begin, offset + size - begin, MADV_WILLNEED);
+}
+
 MappedFile&
 MappedFile::operator=(MappedFile&& other) noexcept {
     map = other.map;
@@ -48,6 +48,12 @@ class MappedFile {
     template<typename T> const T at(size_t offset) const noexcept {
         return reinterpret_cast<T>(map + offset);
     }
+
+    // Length of the mapping in bytes.
+    size_t size() const noexcept { return len; }
+
+    // Ask the OS to start reading a range into memory ahead of its use.
+    void prefetch(size_t offset, size_t size) const noexcept;
     
  private:
     char* map;
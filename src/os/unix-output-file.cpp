@@ -0,0 +1,113 @@
+/********************************
+** Tsunagari Tile Engine       **
+** os/unix-output-file.cpp     **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#include "os/unix-output-file.h"
+
+#include "os/c.h"
+#include "util/move.h"
+#include "util/string.h"
+
+Optional<OutputFile>
+OutputFile::create(StringView path) noexcept {
+    int fd = open(String(path).null(), O_CREAT | O_RDWR | O_TRUNC, 0666);
+    if (fd == -1) {
+        return none;
+    }
+
+    OutputFile file;
+    file.fd = fd;
+    return Optional<OutputFile>(move_(file));
+}
+
+OutputFile::OutputFile() noexcept : fd(-1) {}
+
+OutputFile::OutputFile(OutputFile&& other) noexcept : fd(-1) {
+    *this = move_(other);
+}
+
+OutputFile::~OutputFile() noexcept {
+    if (fd != -1) {
+        close(fd);
+    }
+}
+
+OutputFile&
+OutputFile::operator=(OutputFile&& other) noexcept {
+    if (fd != -1) {
+        close(fd);
+    }
+    fd = other.fd;
+    other.fd = -1;
+    return *this;
+}
+
+bool
+OutputFile::write(const void* data, size_t length) noexcept {
+    const char* p = static_cast<const char*>(data);
+
+    // write() can stop short, so keep going from wherever it left off.
+    while (length > 0) {
+        ssize_t written = ::write(fd, p, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += written;
+        length -= static_cast<size_t>(written);
+    }
+
+    return true;
+}
+
+bool
+OutputFile::seek(uint64_t offset) noexcept {
+    return lseek(fd, static_cast<off_t>(offset), SEEK_SET) != -1;
+}
+
+bool
+OutputFile::read(uint64_t offset, void* data, size_t length) noexcept {
+    char* p = static_cast<char*>(data);
+
+    while (length > 0) {
+        ssize_t got = pread(fd, p, length, static_cast<off_t>(offset));
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (got == 0) {
+            return false;
+        }
+        p += got;
+        offset += static_cast<uint64_t>(got);
+        length -= static_cast<size_t>(got);
+    }
+
+    return true;
+}
@@ -0,0 +1,63 @@
+/********************************
+** Tsunagari Tile Engine       **
+** os/unix-output-file.h       **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#ifndef SRC_OS_UNIX_OUTPUT_FILE_H_
+#define SRC_OS_UNIX_OUTPUT_FILE_H_
+
+#include "util/int.h"
+#include "util/noexcept.h"
+#include "util/optional.h"
+#include "util/string-view.h"
+
+// A file written from front to back, for output too large to build in memory
+// first. What has been written can be read back.
+class OutputFile {
+ public:
+    // Creates the file, or truncates it if it exists.
+    static Optional<OutputFile> create(StringView path) noexcept;
+
+    OutputFile() noexcept;
+    OutputFile(OutputFile&& other) noexcept;
+    OutputFile(const OutputFile& other) = delete;
+    ~OutputFile() noexcept;
+
+    OutputFile& operator=(OutputFile&& other) noexcept;
+
+    // Write at the current position and advance past the data.
+    bool write(const void* data, size_t length) noexcept;
+
+    // Move the current position, for example to go back and fill in a header.
+    bool seek(uint64_t offset) noexcept;
+
+    // Read back data already written at `offset`. The current position stays
+    // where it was.
+    bool read(uint64_t offset, void* data, size_t length) noexcept;
+
+ private:
+    int fd;
+};
+
+#endif  // SRC_OS_UNIX_OUTPUT_FILE_H_
@@ -43,6 +43,30 @@ getFileSize(StringView path_) noexcept {
     return Filesize(static_cast<uint64_t>(status.st_size));
 }
 
+Filetime
+getFileModifiedTime(StringView path_) noexcept {
+    String path(path_);
+
+    struct stat status;
+    if (stat(path.null(), &status)) {
+        return mark;
+    }
+
+#ifdef __APPLE__
+    const struct timespec& mtime = status.st_mtimespec;
+#else
+    const struct timespec& mtime = status.st_mtim;
+#endif
+
+    return Filetime(static_cast<uint64_t>(mtime.tv_sec) * 1000000000 +
+                    static_cast<uint64_t>(mtime.tv_nsec));
+}
+
+bool
+renameFile(StringView from, StringView to) noexcept {
+    return rename(String(from).null(), String(to).null()) == 0;
+}
+
 bool
 isDir(String& path) noexcept {
     struct stat status;
@@ -107,78 +131,57 @@ listDir(StringView path) noexcept {
     return listDir(path_);
 }
 
-bool
-writeFile(String& path, uint32_t length, void* data) noexcept {
-    int fd = open(path.null(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
-    if (fd == -1) {
-        return false;
-    }
-    ssize_t written = write(fd, data, length);
-    if (written != length) {
-        close(fd);
-        return false;
+// Write all of the data, continuing after partial writes.
+static bool
+writeAll(int fd, const char* data, size_t length) noexcept {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
     }
-    close(fd);
     return true;
 }
 
 bool
-writeFile(StringView path, uint32_t length, void* data) noexcept {
-    String path_(path);
-    return writeFile(path_, length, data);
-}
-
-bool
-writeFileVec(String& path, uint32_t count, uint32_t* lengths, void** datas) noexcept {
+writeFile(String& path, size_t length, void* data) noexcept {
     int fd = open(path.null(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
     if (fd == -1) {
         return false;
     }
-
-    ssize_t total = 0;
-    Vector<iovec> ios;
-
-    ios.reserve(count);
-    for (size_t i = 0; i < count; i++) {
-        total += lengths[i];
-        ios.push_back({datas[i], lengths[i]});
-    }
-
-    ssize_t written = writev(fd, ios.data(), static_cast<int>(ios.size()));
-    if (written != total) {
+    if (!writeAll(fd, static_cast<char*>(data), length)) {
         close(fd);
         return false;
     }
-
     close(fd);
     return true;
 }
 
 bool
-writeFileVec(StringView path, uint32_t count, uint32_t* lengths, void** datas) noexcept {
+writeFile(StringView path, size_t length, void* data) noexcept {
     String path_(path);
-    return writeFileVec(path_, count, lengths, datas);
+    return writeFile(path_, length, data);
 }
 
-/*
-bool writeFileVec(String& path, uint32_t count, uint32_t* lengths, void** datas) noexcept {
-    int fd = open(path.null(), O_CREAT | O_WRONLY | O_TRUNC, 0666);
+bool
+appendFile(StringView path, size_t length, const void* data) noexcept {
+    String path_(path);
+    int fd = open(path_.null(), O_CREAT | O_WRONLY | O_APPEND, 0666);
     if (fd == -1) {
         return false;
     }
-    for (size_t i = 0; i < count; i++) {
-        size_t length = lengths[i];
-        void* data = datas[i];
-        ssize_t written = write(fd, data, length);
-        if (written != length) {
-            close(fd);
-            return false;
-        }
+    if (!writeAll(fd, static_cast<const char*>(data), length)) {
+        close(fd);
+        return false;
     }
     close(fd);
     return true;
 }
-*/
 
 Optional<String>
 readFile(String& path) noexcept {
@@ -212,6 +215,105 @@ readFile(StringView s) noexcept {
     return readFile(s_);
 }
 
+#ifdef __linux__
+static int watchFd = -1;
+static String watchRoot;
+
+// Directory of each watch, relative to watchRoot and with a trailing '/',
+// indexed by watch descriptor.
+static Vector<String> watchDirs;
+
+static void
+addWatches(String dir) noexcept {
+    String path = String() << watchRoot << "/" << dir;
+
+    int wd = inotify_add_watch(
+            watchFd, path.null(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0) {
+        return;
+    }
+
+    while (watchDirs.size() <= static_cast<size_t>(wd)) {
+        watchDirs.push_back(String());
+    }
+    watchDirs[wd] = dir;
+
+    for (String& name : listDir(path)) {
+        String child = String() << dir << name;
+        if (isDir(String() << watchRoot << "/" << child)) {
+            addWatches(String() << child << "/");
+        }
+    }
+}
+
+bool
+watchDirectory(StringView path) noexcept {
+    if (watchFd != -1) {
+        return false;
+    }
+
+    watchFd = inotify_init1(IN_NONBLOCK);
+    if (watchFd == -1) {
+        return false;
+    }
+
+    watchRoot = path;
+    addWatches(String());
+    return true;
+}
+
+Vector<String>
+takeChangedFiles() noexcept {
+    Vector<String> paths;
+
+    if (watchFd == -1) {
+        return paths;
+    }
+
+    // Aligned for inotify_event.
+    uint64_t buf[512];
+
+    ssize_t size;
+    while ((size = read(watchFd, buf, sizeof(buf))) > 0) {
+        char* p = reinterpret_cast<char*>(buf);
+        char* end = p + size;
+
+        while (p < end) {
+            inotify_event* event = reinterpret_cast<inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+
+            if (event->wd < 0 ||
+                static_cast<size_t>(event->wd) >= watchDirs.size() ||
+                event->len == 0) {
+                continue;
+            }
+
+            String path = String() << watchDirs[event->wd] << event->name;
+
+            if (event->mask & IN_ISDIR) {
+                // Watch directories created or moved in after we started.
+                addWatches(String() << path << "/");
+            }
+            else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                paths.push_back(move_(path));
+            }
+        }
+    }
+
+    return paths;
+}
+#else
+bool
+watchDirectory(StringView) noexcept {
+    return false;
+}
+
+Vector<String>
+takeChangedFiles() noexcept {
+    return Vector<String>();
+}
+#endif
+
 static bool
 isaTTY() noexcept {
     static bool checked = false;
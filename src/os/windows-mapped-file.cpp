@@ -37,6 +37,11 @@ typedef struct {
     BOOL bInheritHandle;
 } SECURITY_ATTRIBUTES, *PSECURITY_ATTRIBUTES, *LPSECURITY_ATTRIBUTES;
 
+typedef struct {
+    PVOID VirtualAddress;
+    SIZE_T NumberOfBytes;
+} WIN32_MEMORY_RANGE_ENTRY, *PWIN32_MEMORY_RANGE_ENTRY;
+
 WINBASEAPI BOOL WINAPI CloseHandle(HANDLE hObject) noexcept;
 WINBASEAPI HANDLE WINAPI CreateFileA(LPCSTR lpFileName,
                                      DWORD dwDesiredAccess,
@@ -52,11 +57,19 @@ CreateFileMappingA(HANDLE hFile,
                    DWORD dwMaximumSizeHigh,
                    DWORD dwMaximumSizeLow,
                    LPCSTR lpName) noexcept;
+WINBASEAPI HANDLE WINAPI GetCurrentProcess() noexcept;
+WINBASEAPI BOOL WINAPI GetFileSizeEx(HANDLE hFile,
+                                     LARGE_INTEGER* lpFileSize) noexcept;
 WINBASEAPI LPVOID WINAPI MapViewOfFile(HANDLE hFileMappingObject,
                                        DWORD dwDesiredAccess,
                                        DWORD dwFileOffsetHigh,
                                        DWORD dwFileOffsetLow,
                                        SIZE_T dwNumberOfBytesToMap) noexcept;
+WINBASEAPI BOOL WINAPI
+PrefetchVirtualMemory(HANDLE hProcess,
+                      ULONG_PTR NumberOfEntries,
+                      PWIN32_MEMORY_RANGE_ENTRY VirtualAddresses,
+                      ULONG Flags) noexcept;
 WINBASEAPI BOOL WINAPI UnmapViewOfFile(LPCVOID lpBaseAddress) noexcept;
 
 #define CreateFile CreateFileA
@@ -84,6 +97,12 @@ MappedFile::fromPath(StringView path) noexcept {
         return none;
     }
 
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return none;
+    }
+
     HANDLE mapping =
             CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
     if (mapping == nullptr) {
@@ -102,14 +121,21 @@ MappedFile::fromPath(StringView path) noexcept {
     m.file = file;
     m.mapping = mapping;
     m.data = static_cast<char*>(data);
+    m.len = static_cast<size_t>(size.QuadPart);
     return Optional<MappedFile>(move_(m));
 }
 
 MappedFile::MappedFile() noexcept
-        : file(INVALID_HANDLE_VALUE), mapping(nullptr), data(nullptr) {}
+        : file(INVALID_HANDLE_VALUE),
+          mapping(nullptr),
+          data(nullptr),
+          len(0) {}
 
 MappedFile::MappedFile(MappedFile&& other) noexcept
-        : file(INVALID_HANDLE_VALUE), mapping(nullptr), data(nullptr) {
+        : file(INVALID_HANDLE_VALUE),
+          mapping(nullptr),
+          data(nullptr),
+          len(0) {
     *this = move_(other);
 }
 
@@ -125,13 +151,28 @@ MappedFile::~MappedFile() noexcept {
     }
 }
 
+void
+MappedFile::prefetch(size_t offset, size_t size) const noexcept {
+    if (data == nullptr || size == 0 || offset >= len) {
+        return;
+    }
+    if (size > len - offset) {
+        size = len - offset;
+    }
+
+    WIN32_MEMORY_RANGE_ENTRY range = {static_cast<PVOID>(data + offset), size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
 MappedFile&
 MappedFile::operator=(MappedFile&& other) noexcept {
     file = other.file;
     mapping = other.mapping;
     data = other.data;
+    len = other.len;
     other.file = INVALID_HANDLE_VALUE;
     other.mapping = nullptr;
     other.data = nullptr;
+    other.len = 0;
     return *this;
 }
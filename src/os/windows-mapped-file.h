@@ -47,10 +47,17 @@ class MappedFile {
         return reinterpret_cast<T>(data + offset);
     }
 
+    // Length of the mapping in bytes.
+    size_t size() const noexcept { return len; }
+
+    // Ask the OS to start reading a range into memory ahead of its use.
+    void prefetch(size_t offset, size_t size) const noexcept;
+
  private:
     HANDLE file;
     HANDLE mapping;
     char* data;
+    size_t len;
 };
 
 #endif  // SRC_OS_WINDOWS_MAPPED_FILE_H_
@@ -0,0 +1,163 @@
+/********************************
+** Tsunagari Tile Engine       **
+** os/windows-output-file.cpp  **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#include "os/windows-output-file.h"
+
+#include "os/c.h"
+#include "util/move.h"
+#include "util/noexcept.h"
+#include "util/string.h"
+
+extern "C" {
+WINBASEAPI BOOL WINAPI CloseHandle(HANDLE hObject) noexcept;
+WINBASEAPI HANDLE WINAPI CreateFileA(LPCSTR lpFileName,
+                                     DWORD dwDesiredAccess,
+                                     DWORD dwShareMode,
+                                     void* lpSecurityAttributes,
+                                     DWORD dwCreationDisposition,
+                                     DWORD dwFlagsAndAttributes,
+                                     HANDLE hTemplateFile) noexcept;
+WINBASEAPI BOOL WINAPI ReadFile(HANDLE hFile,
+                                LPVOID lpBuffer,
+                                DWORD nNumberOfBytesToRead,
+                                LPDWORD lpNumberOfBytesRead,
+                                void* lpOverlapped) noexcept;
+WINBASEAPI BOOL WINAPI SetFilePointerEx(HANDLE hFile,
+                                        LARGE_INTEGER liDistanceToMove,
+                                        LARGE_INTEGER* lpNewFilePointer,
+                                        DWORD dwMoveMethod) noexcept;
+WINBASEAPI BOOL WINAPI WriteFile(HANDLE hFile,
+                                 LPCVOID lpBuffer,
+                                 DWORD nNumberOfBytesToWrite,
+                                 LPDWORD lpNumberOfBytesWritten,
+                                 void* lpOverlapped) noexcept;
+
+#define CreateFile CreateFileA
+
+#define CREATE_ALWAYS 2
+#define FILE_BEGIN 0
+#define FILE_CURRENT 1
+#define FILE_READ_DATA (0x0001)
+#define FILE_WRITE_DATA (0x0002)
+#define INVALID_HANDLE_VALUE ((HANDLE)(LONG_PTR)-1)
+}
+
+Optional<OutputFile>
+OutputFile::create(StringView path) noexcept {
+    HANDLE file = CreateFile(String(path).null(),
+                             FILE_READ_DATA | FILE_WRITE_DATA,
+                             0,
+                             nullptr,
+                             CREATE_ALWAYS,
+                             0,
+                             nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return none;
+    }
+
+    OutputFile f;
+    f.file = file;
+    return Optional<OutputFile>(move_(f));
+}
+
+OutputFile::OutputFile() noexcept : file(INVALID_HANDLE_VALUE) {}
+
+OutputFile::OutputFile(OutputFile&& other) noexcept
+        : file(INVALID_HANDLE_VALUE) {
+    *this = move_(other);
+}
+
+OutputFile::~OutputFile() noexcept {
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+}
+
+OutputFile&
+OutputFile::operator=(OutputFile&& other) noexcept {
+    if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+    file = other.file;
+    other.file = INVALID_HANDLE_VALUE;
+    return *this;
+}
+
+bool
+OutputFile::write(const void* data, size_t length) noexcept {
+    const char* p = static_cast<const char*>(data);
+
+    // WriteFile() takes a 32-bit length, so write large buffers in pieces.
+    while (length > 0) {
+        DWORD chunk =
+                length > (1 << 30) ? (1 << 30) : static_cast<DWORD>(length);
+        DWORD written;
+        BOOL ok = WriteFile(file, p, chunk, &written, nullptr);
+        if (!ok || written == 0) {
+            return false;
+        }
+        p += written;
+        length -= written;
+    }
+
+    return true;
+}
+
+bool
+OutputFile::seek(uint64_t offset) noexcept {
+    LARGE_INTEGER distance;
+    distance.QuadPart = static_cast<long long>(offset);
+    return SetFilePointerEx(file, distance, nullptr, FILE_BEGIN) != 0;
+}
+
+bool
+OutputFile::read(uint64_t offset, void* data, size_t length) noexcept {
+    // Remember the write position so it can be restored afterward.
+    LARGE_INTEGER zero;
+    zero.QuadPart = 0;
+    LARGE_INTEGER position;
+    if (!SetFilePointerEx(file, zero, &position, FILE_CURRENT) ||
+        !seek(offset)) {
+        return false;
+    }
+
+    char* p = static_cast<char*>(data);
+
+    while (length > 0) {
+        DWORD chunk =
+                length > (1 << 30) ? (1 << 30) : static_cast<DWORD>(length);
+        DWORD got;
+        BOOL ok = ReadFile(file, p, chunk, &got, nullptr);
+        if (!ok || got == 0) {
+            seek(static_cast<uint64_t>(position.QuadPart));
+            return false;
+        }
+        p += got;
+        length -= got;
+    }
+
+    return seek(static_cast<uint64_t>(position.QuadPart));
+}
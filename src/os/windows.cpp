@@ -71,8 +71,11 @@ WINBASEAPI BOOL WINAPI FindClose(HANDLE) noexcept;
 _ACRTIMP FILE* __cdecl freopen(const char*, const char*, FILE*) noexcept;
 WINBASEAPI DWORD WINAPI GetFileAttributesA(LPCSTR) noexcept;
 WINBASEAPI BOOL WINAPI GetFileSizeEx(HANDLE, LARGE_INTEGER*) noexcept;
+WINBASEAPI BOOL WINAPI
+GetFileTime(HANDLE, FILETIME*, FILETIME*, FILETIME*) noexcept;
 WINBASEAPI HANDLE WINAPI GetStdHandle(DWORD) noexcept;
 WINUSERAPI int WINAPI MessageBoxA(HWND, LPCSTR, LPCSTR, UINT) noexcept;
+WINBASEAPI BOOL WINAPI MoveFileExA(LPCSTR, LPCSTR, DWORD) noexcept;
 WINBASEAPI BOOL WINAPI ReadFile(HANDLE, VOID*, DWORD, DWORD*, void*) noexcept;
 WINBASEAPI BOOL WINAPI SetConsoleTextAttribute(HANDLE, WORD) noexcept;
 WINBASEAPI BOOL WINAPI
@@ -83,6 +86,7 @@ typedef WIN32_FIND_DATAA WIN32_FIND_DATA;
 #define CREATE_ALWAYS 2
 #define CreateDirectory CreateDirectoryA
 #define CreateFile CreateFileA
+#define FILE_APPEND_DATA (0x0004)
 #define FILE_ATTRIBUTE_DIRECTORY 0x00000010
 #define FILE_READ_ATTRIBUTES 0x0080
 #define FILE_READ_DATA 0x0001
@@ -97,6 +101,9 @@ typedef WIN32_FIND_DATAA WIN32_FIND_DATA;
 #define INVALID_FILE_ATTRIBUTES ((DWORD)-1)
 #define INVALID_HANDLE_VALUE ((HANDLE)(LONG_PTR)-1)
 #define MessageBox MessageBoxA
+#define MoveFileEx MoveFileExA
+#define MOVEFILE_REPLACE_EXISTING 0x00000001
+#define OPEN_ALWAYS 4
 #define OPEN_EXISTING 3
 #define STD_OUTPUT_HANDLE ((DWORD)-11)
 
@@ -132,8 +139,58 @@ getFileSize(StringView path) noexcept {
     return Filesize(static_cast<uint64_t>(size.QuadPart));
 }
 
+Filetime
+getFileModifiedTime(StringView path) noexcept {
+    HANDLE file = CreateFile(String(path).null(),
+                             FILE_READ_ATTRIBUTES,
+                             0,
+                             nullptr,
+                             OPEN_EXISTING,
+                             0,
+                             nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return mark;
+    }
+
+    FILETIME writeTime;
+    BOOL ok = GetFileTime(file, nullptr, nullptr, &writeTime);
+
+    CloseHandle(file);
+
+    if (!ok) {
+        return mark;
+    }
+
+    return Filetime((static_cast<uint64_t>(writeTime.dwHighDateTime) << 32) |
+                    writeTime.dwLowDateTime);
+}
+
+bool
+renameFile(StringView from, StringView to) noexcept {
+    return MoveFileEx(String(from).null(),
+                      String(to).null(),
+                      MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+// Write all of the data. WriteFile() takes a 32-bit length, so large buffers
+// are written in pieces.
+static bool
+writeAll(HANDLE file, const char* data, size_t length) noexcept {
+    while (length > 0) {
+        DWORD chunk = length > (1 << 30) ? (1 << 30) : static_cast<DWORD>(length);
+        DWORD written;
+        BOOL ok = WriteFile(file, data, chunk, &written, nullptr);
+        if (!ok || written == 0) {
+            return false;
+        }
+        data += written;
+        length -= written;
+    }
+    return true;
+}
+
 bool
-writeFile(StringView path, uint32_t length, void* data) noexcept {
+writeFile(StringView path, size_t length, void* data) noexcept {
     HANDLE file = CreateFile(String(path).null(),
                              FILE_WRITE_DATA,
                              0,
@@ -145,13 +202,7 @@ writeFile(StringView path, uint32_t length, void* data) noexcept {
         return false;
     }
 
-    DWORD written;
-    BOOL ok = WriteFile(file, data, length, &written, nullptr);
-    if (!ok) {
-        CloseHandle(file);
-        return false;
-    }
-    if (length != written) {
+    if (!writeAll(file, static_cast<char*>(data), length)) {
         CloseHandle(file);
         return false;
     }
@@ -162,32 +213,21 @@ writeFile(StringView path, uint32_t length, void* data) noexcept {
 }
 
 bool
-writeFileVec(StringView path,
-             uint32_t count,
-             uint32_t* lengths,
-             void** datas) noexcept {
+appendFile(StringView path, size_t length, const void* data) noexcept {
     HANDLE file = CreateFile(String(path).null(),
-                             FILE_WRITE_DATA,
+                             FILE_APPEND_DATA,
                              0,
                              nullptr,
-                             CREATE_ALWAYS,
+                             OPEN_ALWAYS,
                              0,
                              nullptr);
     if (file == INVALID_HANDLE_VALUE) {
         return false;
     }
 
-    for (uint32_t i = 0; i < count; i++) {
-        DWORD written;
-        BOOL ok = WriteFile(file, datas[i], lengths[i], &written, nullptr);
-        if (!ok) {
-            CloseHandle(file);
-            return false;
-        }
-        if (lengths[i] != written) {
-            CloseHandle(file);
-            return false;
-        }
+    if (!writeAll(file, static_cast<const char*>(data), length)) {
+        CloseHandle(file);
+        return false;
     }
 
     CloseHandle(file);
@@ -278,6 +318,16 @@ readFile(StringView path) noexcept {
     return Optional<String>(move_(data));
 }
 
+bool
+watchDirectory(StringView) noexcept {
+    return false;
+}
+
+Vector<String>
+takeChangedFiles() noexcept {
+    return Vector<String>();
+}
+
 void
 setTermColor(TermColor color) noexcept {
     HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -0,0 +1,268 @@
+/********************************
+** Tsunagari Tile Engine       **
+** lz4.cpp                     **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#include "pack/lz4.h"
+
+#include "os/c.h"
+#include "util/int.h"
+#include "util/noexcept.h"
+
+// Format described at:
+//   https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+
+static constexpr size_t MIN_MATCH = 4;
+
+// The last match must start at least 12 bytes before the end of the block and
+// the last 5 bytes are always literals.
+static constexpr size_t MF_LIMIT = 12;
+static constexpr size_t LAST_LITERALS = 5;
+
+static constexpr size_t MAX_DISTANCE = 65535;
+
+static constexpr int HASH_LOG = 12;
+static constexpr size_t HASH_SIZE = 1 << HASH_LOG;
+
+static inline uint32_t
+read32(const uint8_t* p) noexcept {
+    uint32_t x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static inline uint32_t
+hashSequence(uint32_t sequence) noexcept {
+    return (sequence * 2654435761U) >> (32 - HASH_LOG);
+}
+
+// Write a length that did not fit in its 4-bit token field.
+static inline uint8_t*
+writeLength(uint8_t* op, size_t length) noexcept {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<uint8_t>(length);
+    return op;
+}
+
+// Worst-case number of bytes needed to emit a sequence.
+static inline size_t
+sequenceBound(size_t literals, size_t matchLength) noexcept {
+    return 1 + literals / 255 + 1 + literals + 2 + matchLength / 255 + 1;
+}
+
+size_t
+lz4Compress(const void* src,
+            size_t srcSize,
+            void* dst,
+            size_t dstCapacity) noexcept {
+    const uint8_t* base = static_cast<const uint8_t*>(src);
+    const uint8_t* ip = base;
+    const uint8_t* iend = base + srcSize;
+    const uint8_t* anchor = base;
+
+    uint8_t* ostart = static_cast<uint8_t*>(dst);
+    uint8_t* op = ostart;
+    uint8_t* oend = ostart + dstCapacity;
+
+    if (srcSize >= MF_LIMIT + 1) {
+        const uint8_t* mflimit = iend - MF_LIMIT;
+        const uint8_t* matchlimit = iend - LAST_LITERALS;
+
+        // Positions relative to base. Zero-initialized entries point at the
+        // start of the input, which is still a valid (if unlikely) candidate.
+        uint32_t table[HASH_SIZE] = {0};
+
+        ip++;
+
+        while (ip < mflimit) {
+            uint32_t sequence = read32(ip);
+            uint32_t h = hashSequence(sequence);
+            const uint8_t* ref = base + table[h];
+            table[h] = static_cast<uint32_t>(ip - base);
+
+            if (static_cast<size_t>(ip - ref) > MAX_DISTANCE ||
+                read32(ref) != sequence) {
+                ip++;
+                continue;
+            }
+
+            // Extend the match backwards over pending literals.
+            while (ip > anchor && ref > base && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+
+            // Extend the match forwards.
+            const uint8_t* matchEnd = ip + MIN_MATCH;
+            const uint8_t* refEnd = ref + MIN_MATCH;
+            while (matchEnd < matchlimit && *matchEnd == *refEnd) {
+                matchEnd++;
+                refEnd++;
+            }
+
+            size_t literals = static_cast<size_t>(ip - anchor);
+            size_t matchLength = static_cast<size_t>(matchEnd - ip) - MIN_MATCH;
+            size_t offset = static_cast<size_t>(ip - ref);
+
+            if (sequenceBound(literals, matchLength) >
+                static_cast<size_t>(oend - op)) {
+                return 0;
+            }
+
+            uint8_t* token = op++;
+
+            if (literals >= 15) {
+                *token = 15 << 4;
+                op = writeLength(op, literals - 15);
+            }
+            else {
+                *token = static_cast<uint8_t>(literals << 4);
+            }
+
+            memcpy(op, anchor, literals);
+            op += literals;
+
+            *op++ = static_cast<uint8_t>(offset);
+            *op++ = static_cast<uint8_t>(offset >> 8);
+
+            if (matchLength >= 15) {
+                *token |= 15;
+                op = writeLength(op, matchLength - 15);
+            }
+            else {
+                *token |= static_cast<uint8_t>(matchLength);
+            }
+
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+
+    // The remainder of the input is emitted as literals.
+    size_t literals = static_cast<size_t>(iend - anchor);
+
+    if (1 + literals / 255 + 1 + literals > static_cast<size_t>(oend - op)) {
+        return 0;
+    }
+
+    if (literals >= 15) {
+        *op++ = 15 << 4;
+        op = writeLength(op, literals - 15);
+    }
+    else {
+        *op++ = static_cast<uint8_t>(literals << 4);
+    }
+
+    memcpy(op, anchor, literals);
+    op += literals;
+
+    return static_cast<size_t>(op - ostart);
+}
+
+// Read a length that did not fit in its 4-bit token field.
+static inline bool
+readLength(const uint8_t*& ip, const uint8_t* iend, size_t& length) noexcept {
+    uint8_t b;
+    do {
+        if (ip == iend) {
+            return false;
+        }
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+bool
+lz4Decompress(const void* src,
+              size_t srcSize,
+              void* dst,
+              size_t dstSize) noexcept {
+    const uint8_t* ip = static_cast<const uint8_t*>(src);
+    const uint8_t* iend = ip + srcSize;
+
+    uint8_t* ostart = static_cast<uint8_t*>(dst);
+    uint8_t* op = ostart;
+    uint8_t* oend = ostart + dstSize;
+
+    while (true) {
+        if (ip == iend) {
+            return false;
+        }
+
+        uint8_t token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(ip, iend, literals)) {
+            return false;
+        }
+
+        if (literals > static_cast<size_t>(iend - ip) ||
+            literals > static_cast<size_t>(oend - op)) {
+            return false;
+        }
+
+        memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // The last sequence has no match.
+        if (ip == iend) {
+            break;
+        }
+
+        if (iend - ip < 2) {
+            return false;
+        }
+
+        size_t offset = static_cast<size_t>(ip[0]) |
+                        static_cast<size_t>(ip[1]) << 8;
+        ip += 2;
+
+        if (offset == 0 || offset > static_cast<size_t>(op - ostart)) {
+            return false;
+        }
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(ip, iend, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+
+        if (matchLength > static_cast<size_t>(oend - op)) {
+            return false;
+        }
+
+        // Matches may overlap their own output, so copy byte by byte.
+        const uint8_t* match = op - offset;
+        while (matchLength--) {
+            *op++ = *match++;
+        }
+    }
+
+    return op == oend;
+}
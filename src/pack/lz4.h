@@ -0,0 +1,50 @@
+/********************************
+** Tsunagari Tile Engine       **
+** lz4.h                       **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#ifndef SRC_PACK_LZ4_H_
+#define SRC_PACK_LZ4_H_
+
+#include "util/int.h"
+#include "util/noexcept.h"
+
+// Compress src into dst using the LZ4 block format. Returns the number of
+// bytes written to dst, or 0 if the compressed data would not fit within
+// dstCapacity. Pass a capacity smaller than srcSize to only accept results
+// that actually shrink the input.
+size_t lz4Compress(const void* src,
+                   size_t srcSize,
+                   void* dst,
+                   size_t dstCapacity) noexcept;
+
+// Decompress an LZ4 block into dst, which must be exactly dstSize bytes, the
+// size of the original data. Returns false if src is malformed. Never reads or
+// writes out of bounds, even on corrupt input.
+bool lz4Decompress(const void* src,
+                   size_t srcSize,
+                   void* dst,
+                   size_t dstSize) noexcept;
+
+#endif  // SRC_PACK_LZ4_H_
@@ -27,11 +27,15 @@
 #include "os/c.h"
 #include "os/mutex.h"
 #include "os/os.h"
+#include "pack/file-type.h"
+#include "pack/lz4.h"
 #include "pack/pack-reader.h"
 #include "pack/pack-writer.h"
 #include "pack/ui.h"
 #include "pack/walker.h"
+#include "util/hashtable.h"
 #include "util/int.h"
+#include "util/jobs.h"
 #include "util/move.h"
 #include "util/noexcept.h"
 #include "util/optional.h"
@@ -41,54 +45,225 @@
 
 static String exe;
 
+// Whether to try compressing images and sounds, which are usually already
+// compressed by their own formats.
+static bool compressMedia = false;
+
+// Whether to start images and sounds on page boundaries.
+static bool pageAlignMedia = false;
+
+// File listing paths in the order blobs should be laid out, one per line.
+static StringView orderPath;
+
 static void
 usage() noexcept {
     fprintf(stderr,
-            "usage: %s create [-v] <output-archive> [input-file]...\n",
+            "usage: %s create [-v] [-z] [-a] [--order-from <trace-file>]\n"
+            "           <output-archive> [input-file]...\n",
+            exe.null().get());
+    fprintf(stderr,
+            "       %s update [-v] [-z] [-a] [--order-from <trace-file>]\n"
+            "           <archive> [input-file]...\n",
             exe.null().get());
     fprintf(stderr, "       %s list <input-archive>\n", exe.null().get());
     fprintf(stderr,
             "       %s extract [-v] <input-archive>\n",
             exe.null().get());
+    fprintf(stderr, "       %s verify <input-archive>\n", exe.null().get());
 }
 
 struct CreateArchiveContext {
     Unique<PackWriter> pack;
     Mutex packMutex;
+
+    // When updating, the archive being replaced and when it was written.
+    // Blobs are copied from it instead of being read and compressed again.
+    // PackReader is safe to use from several threads at once.
+    Unique<PackReader> oldPack;
+    Filetime oldPackTime;
 };
 
+// Queue a file found by walk() to be added to the archive.
 static void
 addFile(CreateArchiveContext& ctx, StringView path) noexcept {
-    Optional<String> data = readFile(path);
+    // Write the file path to the pack file with '/' instead of '\\' on Windows.
+    String standardizedPath = path;
+
+    if (dirSeparator != '/') {
+        for (size_t i = 0; i < path.size; i++) {
+            if (standardizedPath[i] == dirSeparator) {
+                standardizedPath[i] = '/';
+            }
+        }
+    }
+
+    LockGuard guard(ctx.packMutex);
+    ctx.pack->addBlob(move_(standardizedPath));
+}
+
+// Use the blob at `index` in the old archive as-is.
+static void
+reuseBlob(CreateArchiveContext& ctx,
+          StringView path,
+          PackReader::BlobIndex index,
+          PackWriter::BlobData& blob) noexcept {
+    blob.uncompressedSize = ctx.oldPack->getBlobSize(index);
+    blob.size = ctx.oldPack->getStoredBlobSize(index);
+    blob.compressed = ctx.oldPack->isBlobCompressed(index);
+    blob.data = ctx.oldPack->getStoredBlobData(index);
+
+    uiShowReusedFile(path, blob.uncompressedSize);
+}
+
+// Whether the blob at `index` in the old archive holds exactly `data`.
+static bool
+sameAsOldBlob(CreateArchiveContext& ctx,
+              PackReader::BlobIndex index,
+              const String& data) noexcept {
+    const void* stored = ctx.oldPack->getStoredBlobData(index);
+    size_t storedSize =
+            static_cast<size_t>(ctx.oldPack->getStoredBlobSize(index));
+
+    if (data.size() == 0) {
+        return true;
+    }
+
+    if (!ctx.oldPack->isBlobCompressed(index)) {
+        return storedSize == data.size() &&
+               memcmp(stored, data.data(), data.size()) == 0;
+    }
+
+    if (ctx.oldPack->getBlobSize(index) != data.size()) {
+        return false;
+    }
+
+    String decompressed;
+    decompressed.resize(data.size());
+
+    return ctx.oldPack->getBlobData(index, decompressed.data()) &&
+           memcmp(decompressed.data(), data.data(), data.size()) == 0;
+}
+
+// Supply the data for a blob while the archive is being written.
+static bool
+loadFile(CreateArchiveContext& ctx,
+         StringView path,
+         PackWriter::BlobData& blob) noexcept {
+    // Turn the pack path back into a file path on Windows.
+    String filePath = path;
+
+    if (dirSeparator != '/') {
+        for (size_t i = 0; i < path.size; i++) {
+            if (filePath[i] == '/') {
+                filePath[i] = dirSeparator;
+            }
+        }
+    }
+
+    // If the file has not been touched since the old archive was written, take
+    // its blob without reading the file.
+    PackReader::BlobIndex oldIndex = PackReader::BLOB_NOT_FOUND;
+    PackReader::BlobSize oldSize = 0;
+
+    if (ctx.oldPack) {
+        oldIndex = ctx.oldPack->findIndex(path);
+        if (oldIndex != PackReader::BLOB_NOT_FOUND) {
+            oldSize = ctx.oldPack->getBlobSize(oldIndex);
+
+            Filesize size = getFileSize(filePath);
+            Filetime time = getFileModifiedTime(filePath);
+
+            if (size && *size == oldSize && time && ctx.oldPackTime &&
+                *time < *ctx.oldPackTime) {
+                reuseBlob(ctx, path, oldIndex, blob);
+                return true;
+            }
+        }
+    }
+
+    Optional<String> data = readFile(filePath);
 
     if (!data) {
         uiShowSkippedMissingFile(path);
-        return;
+        return false;
     }
 
     String data_ = move_(*data);
 
+    // The file was touched, but its contents may be the same.
+    if (oldIndex != PackReader::BLOB_NOT_FOUND && oldSize == data_.size() &&
+        sameAsOldBlob(ctx, oldIndex, data_)) {
+        reuseBlob(ctx, path, oldIndex, blob);
+        return true;
+    }
+
     uiShowAddedFile(path, data_.size());
 
-    // Write the file path to the pack file with '/' instead of '\\' on Windows.
-    String standardizedPath;
+    // Keep the compressed form only if it is smaller than the original.
+    String compressed;
+    size_t compressedSize = 0;
+
+    if (data_.size() > 1 &&
+        (compressMedia || determineFileType(path) != FT_MEDIA)) {
+        compressed.resize(data_.size() - 1);
+        compressedSize = lz4Compress(data_.data(),
+                                     data_.size(),
+                                     compressed.data(),
+                                     compressed.size());
+    }
 
-    if (dirSeparator != '/') {
-        standardizedPath = path;
+    blob.uncompressedSize = data_.size();
 
-        for (size_t i = 0; i < path.size; i++) {
-            if (standardizedPath[i] == dirSeparator) {
-                standardizedPath[i] = '/';
-            }
-        }
+    if (compressedSize > 0) {
+        blob.size = compressedSize;
+        blob.compressed = true;
+        blob.storage = move_(compressed);
+    }
+    else {
+        blob.size = data_.size();
+        blob.compressed = false;
+        blob.storage = move_(data_);
+    }
+
+    blob.data = blob.storage.data();
+    return true;
+}
 
-        path = standardizedPath;
+// Apply the --order-from file, if any.
+static bool
+loadPathOrder(PackWriter& pack) noexcept {
+    if (orderPath.size == 0) {
+        return true;
     }
 
-    LockGuard guard(ctx.packMutex);
-    ctx.pack->addBlob(move_(path), static_cast<uint32_t>(data_.size()), data_.data());
+    Optional<String> order = readFile(orderPath);
+    if (!order) {
+        fprintf(stderr,
+                "%s: %s: could not read\n",
+                exe.null().get(),
+                String(orderPath).null().get());
+        return false;
+    }
+
+    Vector<StringView> orderPaths;
+    StringView rest = *order;
+    while (rest.size > 0) {
+        StringPosition newline = rest.find('\n');
+        size_t end = newline ? *newline : rest.size;
 
-    data_.reset_lose_memory();  // Don't delete data pointer.
+        StringView line = rest.substr(0, end);
+        if (line.size > 0 && line.data[line.size - 1] == '\r') {
+            line = line.substr(0, line.size - 1);
+        }
+        if (line.size > 0) {
+            orderPaths.push_back(line);
+        }
+
+        rest = newline ? rest.substr(end + 1) : StringView();
+    }
+
+    pack.setPathOrder(move_(orderPaths));
+    return true;
 }
 
 static bool
@@ -97,12 +272,66 @@ createArchive(StringView archivePath, Vector<StringView> paths) noexcept {
 
     CreateArchiveContext ctx;
     ctx.pack = PackWriter::make();
+    ctx.pack->setPageAlignMedia(pageAlignMedia);
+
+    if (!loadPathOrder(*ctx.pack)) {
+        return false;
+    }
 
     walk(move_(paths), [&](StringView path) { addFile(ctx, path); });
 
     uiShowWritingArchive(archivePath);
 
-    return ctx.pack->writeToFile(archivePath);
+    return ctx.pack->writeToFile(
+            archivePath, [&](StringView path, PackWriter::BlobData& blob) {
+                return loadFile(ctx, path, blob);
+            });
+}
+
+// Like createArchive, but copy blobs for unchanged files from the existing
+// archive. Falls back to a full build if there is no existing archive.
+static bool
+updateArchive(StringView archivePath, Vector<StringView> paths) noexcept {
+    UI ui;
+
+    CreateArchiveContext ctx;
+    ctx.pack = PackWriter::make();
+    ctx.pack->setPageAlignMedia(pageAlignMedia);
+    ctx.oldPack = PackReader::fromFile(archivePath);
+    ctx.oldPackTime = getFileModifiedTime(archivePath);
+
+    if (!loadPathOrder(*ctx.pack)) {
+        return false;
+    }
+
+    walk(move_(paths), [&](StringView path) { addFile(ctx, path); });
+
+    uiShowWritingArchive(archivePath);
+
+    // The new archive refers to data in the old one, which stays mapped until
+    // we are done writing. Write next to it and then replace it.
+    String tempPath = String() << archivePath << ".tmp";
+
+    bool ok = ctx.pack->writeToFile(
+            tempPath, [&](StringView path, PackWriter::BlobData& blob) {
+                return loadFile(ctx, path, blob);
+            });
+    if (!ok) {
+        return false;
+    }
+
+    ctx.pack = nullptr;
+    ctx.oldPack = nullptr;
+
+    if (!renameFile(tempPath, archivePath)) {
+        fprintf(stderr,
+                "%s: %s: could not replace\n",
+                exe.null().get(),
+                String(archivePath).null().get());
+        return false;
+    }
+
+    return true;
 }
 
 static bool
@@ -143,7 +372,8 @@ listArchive(StringView archivePath) noexcept {
     else {
         fprintf(stderr,
                 "%s",
-                (String() << exe << ": " << archivePath << ": not found\n")
+                (String() << exe << ": " << archivePath
+                          << ": not found or corrupt\n")
                         .null()
                         .get());
         return false;
@@ -161,73 +391,155 @@ getParentPath(StringView path) noexcept {
     }
 }
 
+struct ExtractArchiveContext {
+    Unique<PackReader> pack;
+
+    // Directories we have already created. Guarded by mutex.
+    Hashset<String> createdDirs;
+    bool failed = false;
+    Mutex mutex;
+};
+
+// Call with ctx.mutex held, so no one writes into a directory we have marked
+// as created before it exists.
 static void
-createDirs(StringView path) noexcept {
+createDirs(ExtractArchiveContext& ctx, StringView path) noexcept {
     Optional<StringView> parentPath = getParentPath(path);
-    if (parentPath) {
-        // Make sure parentPath's parent exists.
-        createDirs(*parentPath);
-
-        makeDirectory(*parentPath);
+    if (!parentPath || ctx.createdDirs.contains(*parentPath)) {
+        return;
     }
-}
 
-static void
-putFile(StringView path, uint32_t size, void* data) noexcept {
-    createDirs(path);
+    // Make sure parentPath's parent exists.
+    createDirs(ctx, *parentPath);
 
-    // TODO: Propagate error up.
-    writeFile(path, size, data);
+    makeDirectory(*parentPath);
+    ctx.createdDirs.insert(String(*parentPath));
 }
 
-static bool
-extractArchive(StringView archivePath) noexcept {
-    UI ui;
+static void
+extractFile(ExtractArchiveContext& ctx, PackReader::BlobIndex index) noexcept {
+    StringView blobPath = ctx.pack->getBlobPath(index);
+    uint64_t blobSize = ctx.pack->getBlobSize(index);
 
-    Unique<PackReader> pack = PackReader::fromFile(archivePath);
+    // Change file paths to use '\\' on Windows.
+    String standardizedPath;
 
-    if (pack) {
-        Vector<PackReader::BlobIndex> blobIndicies;
-        for (PackReader::BlobIndex i = 0; i < pack->size(); i++) {
-            blobIndicies.push_back(i);
+    if (dirSeparator != '/') {
+        standardizedPath = blobPath;
+
+        for (size_t i = 0; i < blobPath.size; i++) {
+            if (standardizedPath[i] == '/') {
+                standardizedPath[i] = dirSeparator;
+            }
         }
 
-        Vector<void*> blobDatas = pack->getBlobDatas(blobIndicies);
+        blobPath = standardizedPath;
+    }
 
-        for (PackReader::BlobIndex i = 0; i < pack->size(); i++) {
-            StringView blobPath = pack->getBlobPath(i);
-            uint32_t blobSize = pack->getBlobSize(i);
-            void* blobData = blobDatas[i];
+    // Uncompressed blobs are written straight out of the mapped archive.
+    // Compressed ones are decompressed into a buffer we free right after.
+    String decompressed;
+    if (ctx.pack->isBlobCompressed(index)) {
+        decompressed.resize(static_cast<size_t>(blobSize));
+    }
 
-            // Change file paths to use '\\' on Windows.
-            String standardizedPath;
+    const void* data = ctx.pack->getBlobData(index, decompressed.data());
+    if (!data) {
+        fprintf(stderr,
+                "%s",
+                (String() << exe << ": " << blobPath << ": corrupt\n")
+                        .null()
+                        .get());
+        LockGuard guard(ctx.mutex);
+        ctx.failed = true;
+        return;
+    }
 
-            if (dirSeparator != '/') {
-                standardizedPath = blobPath;
+    uiShowExtractingFile(blobPath, blobSize);
 
-                for (size_t i = 0; i < blobPath.size; i++) {
-                    if (standardizedPath[i] == '/') {
-                        standardizedPath[i] = dirSeparator;
-                    }
-                }
+    {
+        LockGuard guard(ctx.mutex);
+        createDirs(ctx, blobPath);
+    }
 
-                blobPath = standardizedPath;
-            }
+    if (!writeFile(blobPath,
+                   static_cast<size_t>(blobSize),
+                   const_cast<void*>(data))) {
+        fprintf(stderr,
+                "%s",
+                (String() << exe << ": " << blobPath << ": could not write\n")
+                        .null()
+                        .get());
+        LockGuard guard(ctx.mutex);
+        ctx.failed = true;
+    }
+}
 
-            uiShowExtractingFile(blobPath, blobSize);
+static bool
+extractArchive(StringView archivePath) noexcept {
+    UI ui;
 
-            putFile(blobPath, blobSize, blobData);
-        }
+    ExtractArchiveContext ctx;
+    ctx.pack = PackReader::fromFile(archivePath);
 
-        return true;
+    if (!ctx.pack) {
+        fprintf(stderr,
+                "%s: %s: not found or corrupt\n",
+                exe.null().get(),
+                String(archivePath).null().get());
+        return false;
     }
-    else {
+
+    for (PackReader::BlobIndex i = 0; i < ctx.pack->size(); i++) {
+        JobsEnqueue([&ctx, i] { extractFile(ctx, i); });
+    }
+
+    JobsFlush();
+
+    return !ctx.failed;
+}
+
+static bool
+verifyArchive(StringView archivePath) noexcept {
+    Unique<PackReader> pack = PackReader::fromFile(archivePath);
+
+    if (!pack) {
+        fprintf(stderr,
+                "%s: %s: not found or corrupt\n",
+                exe.null().get(),
+                String(archivePath).null().get());
+        return false;
+    }
+
+    if (!pack->hasChecksums()) {
         fprintf(stderr,
-                "%s: %s: not found\n",
+                "%s: %s: archive has no checksums\n",
                 exe.null().get(),
                 String(archivePath).null().get());
         return false;
     }
+
+    bool failed = false;
+    Mutex mutex;
+
+    for (PackReader::BlobIndex i = 0; i < pack->size(); i++) {
+        JobsEnqueue([&, i] {
+            if (pack->verifyBlob(i)) {
+                return;
+            }
+
+            LockGuard guard(mutex);
+            fprintf(stderr,
+                    "%s: %s: corrupt\n",
+                    exe.null().get(),
+                    String(pack->getBlobPath(i)).null().get());
+            failed = true;
+        });
+    }
+
+    JobsFlush();
+
+    return !failed;
 }
 
 int
@@ -256,9 +568,24 @@ main(int argc, char* argv[]) noexcept {
 
     int exitCode;
 
-    if (command == "create") {
-        if (args.size() > 0 && args[0] == "-v") {
-            verbose = true;
+    if (command == "create" || command == "update") {
+        while (args.size() > 0) {
+            if (args[0] == "-v") {
+                verbose = true;
+            }
+            else if (args[0] == "-z") {
+                compressMedia = true;
+            }
+            else if (args[0] == "-a") {
+                pageAlignMedia = true;
+            }
+            else if (args[0] == "--order-from" && args.size() > 1) {
+                args.erase(args.begin());
+                orderPath = args[0];
+            }
+            else {
+                break;
+            }
             args.erase(args.begin());
         }
 
@@ -271,7 +598,12 @@ main(int argc, char* argv[]) noexcept {
         StringView archivePath = args[0];
         args.erase(args.begin());
 
-        return createArchive(archivePath, move_(args)) ? 0 : 1;
+        if (command == "create") {
+            return createArchive(archivePath, move_(args)) ? 0 : 1;
+        }
+        else {
+            return updateArchive(archivePath, move_(args)) ? 0 : 1;
+        }
     }
     else if (command == "list") {
         verbose = true;
@@ -296,6 +628,14 @@ main(int argc, char* argv[]) noexcept {
 
         exitCode = extractArchive(args[0]) ? 0 : 1;
     }
+    else if (command == "verify") {
+        if (args.size() != 1) {
+            usage();
+            return 1;
+        }
+
+        exitCode = verifyArchive(args[0]) ? 0 : 1;
+    }
     else {
         usage();
         return 1;
@@ -0,0 +1,132 @@
+/********************************
+** Tsunagari Tile Engine       **
+** pack-format.h               **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#ifndef SRC_PACK_PACK_FORMAT_H_
+#define SRC_PACK_PACK_FORMAT_H_
+
+#include "util/int.h"
+
+// Layout of a pack file, shared by PackReader and PackWriter.
+//
+// Version 1:
+//   HeaderBlock32 (without the lookup fields)
+//   PathOffset32[blobCount + 1]
+//   char[pathsBlockSize]
+//   BlobMetadata32[blobCount]
+//   uint32_t[blobCount]  (data offsets)
+//   blob data
+//
+// Version 2:
+//   HeaderBlock64
+//   PathOffset64[blobCount + 1]
+//   char[pathsBlockSize]
+//   BlobMetadata64[blobCount]
+//   uint64_t[blobCount]  (data offsets)
+//   LookupBucket[lookupBucketCount]
+//   blob data
+//
+// Version 2 widens every offset and size to 64 bits, so archives and blobs
+// can exceed 4 GiB. Blocks after the paths are 8-byte aligned. The lookup
+// block is an open-addressed hash table of paths, so readers can find blobs
+// without building one themselves. Each blob's checksum is the low 32 bits of
+// xxHash64 (seed 0) over its stored bytes, so compressed blobs are checked
+// before they are decompressed.
+//
+// Writers only produce version 2. Readers still accept version 1.
+//
+// Blob data need not be contiguous. Writers may pad between blobs, for example
+// to start media on a PACK_PAGE_SIZE boundary, so readers must always go
+// through the data offsets. Blobs with identical contents may share one data
+// offset, so blob data is not in index order either. Likewise, readers must
+// find blocks through the header rather than assume the order above:
+// PackWriter streams the blob data out first and writes the other blocks after
+// it.
+
+//                                       "T   s    u    n    a   g    a   r"
+static constexpr uint8_t PACK_MAGIC[8] = {84, 115, 117, 110, 97, 103, 97, 114};
+
+static constexpr uint8_t PACK_VERSION = 2;
+
+// Alignment used for page-aligned blobs.
+static constexpr uint64_t PACK_PAGE_SIZE = 4096;
+
+enum BlobCompressionType { BLOB_COMPRESSION_NONE, BLOB_COMPRESSION_LZ4 };
+
+// Version 1.
+struct HeaderBlock32 {
+    uint8_t magic[8];
+    uint8_t version;
+    uint8_t unused[7];
+    uint32_t blobCount;
+    uint32_t pathOffsetsBlockOffset;
+    uint32_t pathsBlockOffset;
+    uint32_t pathsBlockSize;
+    uint32_t metadataBlockOffset;
+    uint32_t dataOffsetsBlockOffset;
+};
+
+typedef uint32_t PathOffset32;
+
+struct BlobMetadata32 {
+    uint32_t uncompressedSize;
+    uint32_t compressedSize;
+    BlobCompressionType compressionType;
+};
+
+// Version 2.
+struct HeaderBlock64 {
+    uint8_t magic[8];
+    uint8_t version;
+    uint8_t unused[7];
+    uint32_t blobCount;
+    uint32_t lookupBucketCount;  // Power of two.
+    uint64_t pathOffsetsBlockOffset;
+    uint64_t pathsBlockOffset;
+    uint64_t pathsBlockSize;
+    uint64_t metadataBlockOffset;
+    uint64_t dataOffsetsBlockOffset;
+    uint64_t lookupBlockOffset;
+};
+
+typedef uint64_t PathOffset64;
+
+struct BlobMetadata64 {
+    uint64_t uncompressedSize;
+    uint64_t compressedSize;
+    BlobCompressionType compressionType;
+    uint32_t checksum;
+};
+
+// A slot in the lookup block. Paths hash with fnvHash32 and probe linearly
+// from bucket (hash & (lookupBucketCount - 1)) until a match or an empty slot.
+struct LookupBucket {
+    uint32_t hash;
+    uint32_t blobIndex;  // LOOKUP_EMPTY if unused.
+};
+
+static constexpr uint32_t LOOKUP_EMPTY = UINT32_MAX;
+
+#endif  // SRC_PACK_PACK_FORMAT_H_
@@ -28,68 +28,67 @@
 
 #include "os/c.h"
 #include "os/mapped-file.h"
+#include "pack/lz4.h"
+#include "pack/pack-format.h"
+#include "util/fnv.h"
 #include "util/hashtable.h"
 #include "util/int.h"
 #include "util/move.h"
 #include "util/noexcept.h"
 #include "util/optional.h"
+#include "util/sort.h"
+#include "util/xxhash.h"
 
-//                                       "T   s    u    n    a   g    a   r"
-static constexpr uint8_t PACK_MAGIC[8] = {84, 115, 117, 110, 97, 103, 97, 114};
-
-static constexpr uint8_t PACK_VERSION = 1;
-
-struct HeaderBlock {
-    uint8_t magic[8];
-    uint8_t version;
-    uint8_t unused[7];
-    PackReader::BlobIndex blobCount;
-    uint32_t pathOffsetsBlockOffset;
-    uint32_t pathsBlockOffset;
-    uint32_t pathsBlockSize;
-    uint32_t metadataBlockOffset;
-    uint32_t dataOffsetsBlockOffset;
-};
-
-typedef uint32_t PathOffset;
-
-enum BlobCompressionType { BLOB_COMPRESSION_NONE };
-
-struct BlobMetadata {
-    PackReader::BlobSize uncompressedSize;
-    PackReader::BlobSize compressedSize;
-    BlobCompressionType compressionType;
-};
-
+// Reads archives whose offsets and sizes are of type Offset. Version 1 uses
+// 32-bit offsets, version 2 uses 64-bit.
+//
+// Everything is built in open() and read-only afterward, so any number of
+// threads may read without locking.
+template<typename Header, typename Offset, typename Metadata>
 class PackReaderImpl : public PackReader {
  public:
+    static Unique<PackReader> open(MappedFile file) noexcept;
+
     BlobIndex size() const noexcept;
 
     BlobIndex findIndex(StringView path) noexcept;
 
     StringView getBlobPath(BlobIndex index) const noexcept;
     BlobSize getBlobSize(BlobIndex index) const noexcept;
-    void* getBlobData(BlobIndex index) noexcept;
+    const void* getBlobData(BlobIndex index, void* buffer) const noexcept;
+
+    bool isBlobCompressed(BlobIndex index) const noexcept;
+    BlobSize getStoredBlobSize(BlobIndex index) const noexcept;
+    const void* getStoredBlobData(BlobIndex index) const noexcept;
 
-    Vector<void*> getBlobDatas(Vector<BlobIndex> indicies) noexcept;
+    bool hasChecksums() const noexcept;
+    bool verifyBlob(BlobIndex index) const noexcept;
+
+    void prefetch(Vector<BlobIndex> indicies) noexcept;
 
  public:
+    bool validate() const noexcept;
+    BlobIndex findIndexInLookupBlock(StringView path) const noexcept;
     void constructLookups() noexcept;
 
  public:
     MappedFile file;
 
     // Pointers into `file`.
-    const HeaderBlock* header;
-    const PathOffset* pathOffsets;
+    const Header* header;
+    const Offset* pathOffsets;
     const char* paths;
-    const BlobMetadata* metadatas;
-    const uint32_t* dataOffsets;
+    const Metadata* metadatas;
+    const Offset* dataOffsets;
+    const LookupBucket* lookupBuckets;  // Null in version 1.
 
-    bool lookupsConstructed = false;
+    // Version 1 archives have no lookup block, so we build one when opening.
     Hashmap<StringView, BlobIndex> lookups;
 };
 
+typedef PackReaderImpl<HeaderBlock32, uint32_t, BlobMetadata32> PackReader32;
+typedef PackReaderImpl<HeaderBlock64, uint64_t, BlobMetadata64> PackReader64;
+
 Unique<PackReader>
 PackReader::fromFile(StringView path) noexcept {
     Optional<MappedFile> maybeFile = MappedFile::fromPath(path);
@@ -99,50 +98,207 @@ PackReader::fromFile(StringView path) noexcept {
 
     MappedFile file = move_(*maybeFile);
 
-    size_t offset = 0;
+    // All versions start with the magic number and version.
+    if (file.size() < sizeof(HeaderBlock32::magic) +
+                              sizeof(HeaderBlock32::version)) {
+        return Unique<PackReader>();
+    }
 
-    HeaderBlock* header = file.at<HeaderBlock*>(offset);
-    offset += sizeof(*header);
+    const HeaderBlock32* header = file.at<HeaderBlock32*>(0);
 
     if (memcmp(header->magic, PACK_MAGIC, sizeof(header->magic)) != 0) {
         return Unique<PackReader>();
     }
 
-    if (header->version != PACK_VERSION) {
+    switch (header->version) {
+    case 1:
+        return PackReader32::open(move_(file));
+    case 2:
+        return PackReader64::open(move_(file));
+    default:
         return Unique<PackReader>();
     }
+}
+
+// Only version 2 headers have lookup fields.
+static uint64_t
+lookupBlockOffsetOf(const HeaderBlock32*) noexcept {
+    return 0;
+}
+
+static uint64_t
+lookupBlockOffsetOf(const HeaderBlock64* header) noexcept {
+    return header->lookupBlockOffset;
+}
 
+static uint32_t
+lookupBucketCountOf(const HeaderBlock32*) noexcept {
+    return 0;
+}
+
+static uint32_t
+lookupBucketCountOf(const HeaderBlock64* header) noexcept {
+    return header->lookupBucketCount;
+}
+
+template<typename Header, typename Offset, typename Metadata>
+Unique<PackReader>
+PackReaderImpl<Header, Offset, Metadata>::open(MappedFile file) noexcept {
     PackReaderImpl* reader = new PackReaderImpl;
     reader->file = move_(file);
+
+    const Header* header = reader->file.template at<Header*>(0);
     reader->header = header;
 
-    BlobIndex blobCount = header->blobCount;
+    if (!reader->validate()) {
+        delete reader;
+        return Unique<PackReader>();
+    }
 
-    reader->pathOffsets = reader->file.at<PathOffset*>(offset);
-    offset += (blobCount + 1) * sizeof(PathOffset);
+    reader->pathOffsets =
+            reader->file.template at<Offset*>(header->pathOffsetsBlockOffset);
+    reader->paths = reader->file.template at<char*>(header->pathsBlockOffset);
+    reader->metadatas =
+            reader->file.template at<Metadata*>(header->metadataBlockOffset);
+    reader->dataOffsets =
+            reader->file.template at<Offset*>(header->dataOffsetsBlockOffset);
+
+    if (header->version >= 2) {
+        reader->lookupBuckets = reader->file.template at<LookupBucket*>(
+                lookupBlockOffsetOf(header));
+    }
+    else {
+        reader->lookupBuckets = nullptr;
+        reader->constructLookups();
+    }
 
-    reader->paths = reader->file.at<char*>(offset);
-    offset += header->pathsBlockSize;
+    return Unique<PackReader>(reader);
+}
 
-    reader->metadatas = reader->file.at<BlobMetadata*>(offset);
-    offset += blobCount * sizeof(BlobMetadata);
+// Whether `count` elements of `elementSize` bytes starting at `offset` lie
+// within a file of `fileSize` bytes, without overflowing.
+static bool
+inBounds(uint64_t offset,
+         uint64_t count,
+         uint64_t elementSize,
+         size_t fileSize) noexcept {
+    if (offset > fileSize) {
+        return false;
+    }
+    return count <= (fileSize - offset) / elementSize;
+}
 
-    reader->dataOffsets = reader->file.at<uint32_t*>(offset);
-    // offset += blobCount * sizeof(uint64_t);
+// Check every offset and size the reader will later trust against the length
+// of the file, so a truncated or corrupt archive fails to open instead of
+// reading outside the mapping.
+template<typename Header, typename Offset, typename Metadata>
+bool
+PackReaderImpl<Header, Offset, Metadata>::validate() const noexcept {
+    size_t fileSize = file.size();
 
-    return Unique<PackReader>(reader);
+    if (fileSize < sizeof(Header)) {
+        return false;
+    }
+
+    uint64_t blobCount = header->blobCount;
+
+    if (!inBounds(header->pathOffsetsBlockOffset,
+                  blobCount + 1,
+                  sizeof(Offset),
+                  fileSize) ||
+        !inBounds(header->pathsBlockOffset,
+                  header->pathsBlockSize,
+                  1,
+                  fileSize) ||
+        !inBounds(header->metadataBlockOffset,
+                  blobCount,
+                  sizeof(Metadata),
+                  fileSize) ||
+        !inBounds(header->dataOffsetsBlockOffset,
+                  blobCount,
+                  sizeof(Offset),
+                  fileSize)) {
+        return false;
+    }
+
+    const Offset* pathOffsets_ =
+            file.template at<Offset*>(header->pathOffsetsBlockOffset);
+    const Metadata* metadatas_ =
+            file.template at<Metadata*>(header->metadataBlockOffset);
+    const Offset* dataOffsets_ =
+            file.template at<Offset*>(header->dataOffsetsBlockOffset);
+
+    if (pathOffsets_[blobCount] > header->pathsBlockSize) {
+        return false;
+    }
+
+    for (uint64_t i = 0; i < blobCount; i++) {
+        if (pathOffsets_[i] > pathOffsets_[i + 1]) {
+            return false;
+        }
+
+        const Metadata& metadata = metadatas_[i];
+        if (!inBounds(dataOffsets_[i], metadata.compressedSize, 1, fileSize)) {
+            return false;
+        }
+
+        switch (metadata.compressionType) {
+        case BLOB_COMPRESSION_NONE:
+            if (metadata.compressedSize != metadata.uncompressedSize) {
+                return false;
+            }
+            break;
+        case BLOB_COMPRESSION_LZ4:
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if (header->version < 2) {
+        return true;
+    }
+
+    // Lookups probe until they reach an empty bucket, so there must be one.
+    uint32_t bucketCount = lookupBucketCountOf(header);
+    if (bucketCount == 0 || (bucketCount & (bucketCount - 1)) != 0) {
+        return false;
+    }
+    if (!inBounds(lookupBlockOffsetOf(header),
+                  bucketCount,
+                  sizeof(LookupBucket),
+                  fileSize)) {
+        return false;
+    }
+
+    const LookupBucket* buckets =
+            file.template at<LookupBucket*>(lookupBlockOffsetOf(header));
+
+    bool hasEmpty = false;
+    for (uint32_t i = 0; i < bucketCount; i++) {
+        uint32_t blobIndex = buckets[i].blobIndex;
+        if (blobIndex == LOOKUP_EMPTY) {
+            hasEmpty = true;
+        }
+        else if (blobIndex >= blobCount) {
+            return false;
+        }
+    }
+
+    return hasEmpty;
 }
 
+template<typename Header, typename Offset, typename Metadata>
 PackReader::BlobIndex
-PackReaderImpl::size() const noexcept {
+PackReaderImpl<Header, Offset, Metadata>::size() const noexcept {
     return header->blobCount;
 }
 
+template<typename Header, typename Offset, typename Metadata>
 PackReader::BlobIndex
-PackReaderImpl::findIndex(StringView path) noexcept {
-    if (!lookupsConstructed) {
-        lookupsConstructed = true;
-        constructLookups();
+PackReaderImpl<Header, Offset, Metadata>::findIndex(StringView path) noexcept {
+    if (lookupBuckets) {
+        return findIndexInLookupBlock(path);
     }
 
     auto it = lookups.find(path);
@@ -154,40 +310,176 @@ PackReaderImpl::findIndex(StringView path) noexcept {
     }
 }
 
+template<typename Header, typename Offset, typename Metadata>
+PackReader::BlobIndex
+PackReaderImpl<Header, Offset, Metadata>::findIndexInLookupBlock(
+        StringView path) const noexcept {
+    uint32_t hash = fnvHash32(path.data, path.size);
+    uint32_t mask = lookupBucketCountOf(header) - 1;
+
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        const LookupBucket& bucket = lookupBuckets[i];
+        if (bucket.blobIndex == LOOKUP_EMPTY) {
+            return BLOB_NOT_FOUND;
+        }
+        if (bucket.hash == hash && getBlobPath(bucket.blobIndex) == path) {
+            return bucket.blobIndex;
+        }
+    }
+}
+
+template<typename Header, typename Offset, typename Metadata>
 StringView
-PackReaderImpl::getBlobPath(PackReader::BlobIndex index) const noexcept {
-    uint32_t begin = pathOffsets[index];
-    uint32_t end = pathOffsets[index + 1];
-    return StringView(paths + begin, end - begin);
+PackReaderImpl<Header, Offset, Metadata>::getBlobPath(
+        PackReader::BlobIndex index) const noexcept {
+    Offset begin = pathOffsets[index];
+    Offset end = pathOffsets[index + 1];
+    return StringView(paths + begin, static_cast<size_t>(end - begin));
 }
 
+template<typename Header, typename Offset, typename Metadata>
 PackReader::BlobSize
-PackReaderImpl::getBlobSize(PackReader::BlobIndex index) const noexcept {
+PackReaderImpl<Header, Offset, Metadata>::getBlobSize(
+        PackReader::BlobIndex index) const noexcept {
     return metadatas[index].uncompressedSize;
 }
 
-void*
-PackReaderImpl::getBlobData(PackReader::BlobIndex index) noexcept {
-    return file.at<void*>(dataOffsets[index]);
+template<typename Header, typename Offset, typename Metadata>
+const void*
+PackReaderImpl<Header, Offset, Metadata>::getBlobData(
+        PackReader::BlobIndex index,
+        void* buffer) const noexcept {
+    const Metadata& metadata = metadatas[index];
+    const void* data = file.template at<const void*>(dataOffsets[index]);
+
+    switch (metadata.compressionType) {
+    case BLOB_COMPRESSION_NONE:
+        return data;
+    case BLOB_COMPRESSION_LZ4:
+        break;
+    default:
+        return nullptr;
+    }
+
+    size_t uncompressedSize = static_cast<size_t>(metadata.uncompressedSize);
+    size_t compressedSize = static_cast<size_t>(metadata.compressedSize);
+
+    if (!lz4Decompress(data, compressedSize, buffer, uncompressedSize)) {
+        return nullptr;
+    }
+
+    return buffer;
+}
+
+template<typename Header, typename Offset, typename Metadata>
+bool
+PackReaderImpl<Header, Offset, Metadata>::isBlobCompressed(
+        PackReader::BlobIndex index) const noexcept {
+    return metadatas[index].compressionType != BLOB_COMPRESSION_NONE;
+}
+
+template<typename Header, typename Offset, typename Metadata>
+PackReader::BlobSize
+PackReaderImpl<Header, Offset, Metadata>::getStoredBlobSize(
+        PackReader::BlobIndex index) const noexcept {
+    return metadatas[index].compressedSize;
+}
+
+template<typename Header, typename Offset, typename Metadata>
+const void*
+PackReaderImpl<Header, Offset, Metadata>::getStoredBlobData(
+        PackReader::BlobIndex index) const noexcept {
+    return file.template at<const void*>(dataOffsets[index]);
+}
+
+// Only 64-bit metadata has room for a checksum.
+static uint32_t
+checksumOf(const BlobMetadata32&) noexcept {
+    return 0;
+}
+
+static uint32_t
+checksumOf(const BlobMetadata64& metadata) noexcept {
+    return metadata.checksum;
+}
+
+template<typename Header, typename Offset, typename Metadata>
+bool
+PackReaderImpl<Header, Offset, Metadata>::hasChecksums() const noexcept {
+    return header->version >= 2;
+}
+
+template<typename Header, typename Offset, typename Metadata>
+bool
+PackReaderImpl<Header, Offset, Metadata>::verifyBlob(
+        PackReader::BlobIndex index) const noexcept {
+    if (!hasChecksums()) {
+        return true;
+    }
+
+    const void* data = getStoredBlobData(index);
+    size_t size = static_cast<size_t>(metadatas[index].compressedSize);
+
+    uint32_t checksum = static_cast<uint32_t>(xxHash64(data, size, 0));
+    return checksum == checksumOf(metadatas[index]);
+}
+
+// A span of the archive to prefetch.
+struct PrefetchRange {
+    uint64_t begin;
+    uint64_t end;
+};
+
+static bool
+operator<(const PrefetchRange& a, const PrefetchRange& b) noexcept {
+    return a.begin < b.begin;
 }
 
-Vector<void*>
-PackReaderImpl::getBlobDatas(Vector<BlobIndex> indicies) noexcept {
-    Vector<void*> datas;
+template<typename Header, typename Offset, typename Metadata>
+void
+PackReaderImpl<Header, Offset, Metadata>::prefetch(
+        Vector<BlobIndex> indicies) noexcept {
+    if (indicies.size() == 0) {
+        return;
+    }
+
+    // Sorting by offset lets us merge blobs that sit near each other into one
+    // request. Offsets are not in index order since blobs may share data.
+    Vector<PrefetchRange> ranges;
+    ranges.reserve(indicies.size());
 
     for (BlobIndex i : indicies) {
-        datas.push_back(file.at<void*>(dataOffsets[i]));
+        uint64_t begin = dataOffsets[i];
+        ranges.push_back({begin, begin + metadatas[i].compressedSize});
+    }
+
+    pdqsort(ranges.begin(), ranges.end());
+
+    uint64_t rangeBegin = ranges[0].begin;
+    uint64_t rangeEnd = ranges[0].end;
+
+    for (size_t i = 1; i < ranges.size(); i++) {
+        if (ranges[i].begin <= rangeEnd + PACK_PAGE_SIZE) {
+            if (rangeEnd < ranges[i].end) {
+                rangeEnd = ranges[i].end;
+            }
+            continue;
+        }
+
+        file.prefetch(static_cast<size_t>(rangeBegin),
+                      static_cast<size_t>(rangeEnd - rangeBegin));
+        rangeBegin = ranges[i].begin;
+        rangeEnd = ranges[i].end;
     }
 
-    return datas;
+    file.prefetch(static_cast<size_t>(rangeBegin),
+                  static_cast<size_t>(rangeEnd - rangeBegin));
 }
 
+template<typename Header, typename Offset, typename Metadata>
 void
-PackReaderImpl::constructLookups() noexcept {
+PackReaderImpl<Header, Offset, Metadata>::constructLookups() noexcept {
     for (PackReader::BlobIndex i = 0; i < header->blobCount; i++) {
-        uint32_t pathBegin = pathOffsets[i];
-        uint32_t pathEnd = pathOffsets[i + 1];
-        StringView blobPath(paths + pathBegin, pathEnd - pathBegin);
-        lookups[blobPath] = i;
+        lookups[getBlobPath(i)] = i;
     }
 }
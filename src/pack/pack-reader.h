@@ -33,10 +33,11 @@
 #include "util/unique.h"
 #include "util/vector.h"
 
+// Once opened, a PackReader may be used from several threads at once.
 class PackReader {
  public:
     typedef uint32_t BlobIndex;
-    typedef uint32_t BlobSize;
+    typedef uint64_t BlobSize;
 
     static constexpr BlobIndex BLOB_NOT_FOUND = UINT32_MAX;
 
@@ -49,9 +50,33 @@ class PackReader {
 
     virtual StringView getBlobPath(BlobIndex index) const noexcept = 0;
     virtual BlobSize getBlobSize(BlobIndex index) const noexcept = 0;
-    virtual void* getBlobData(BlobIndex index) noexcept = 0;
 
-    virtual Vector<void*> getBlobDatas(Vector<BlobIndex> indicies) noexcept = 0;
+    // Returns a pointer into the archive for blobs stored uncompressed, which
+    // lives as long as the PackReader. Blobs stored compressed are
+    // decompressed into `buffer`, which the caller provides with room for
+    // getBlobSize() bytes, and `buffer` is returned. Returns nullptr if the
+    // blob is corrupt.
+    virtual const void* getBlobData(BlobIndex index,
+                                    void* buffer) const noexcept = 0;
+
+    // The blob as it is stored in the archive, which may be compressed. Lets
+    // PackWriter copy a blob from one archive to another without recompressing
+    // it.
+    virtual bool isBlobCompressed(BlobIndex index) const noexcept = 0;
+    virtual BlobSize getStoredBlobSize(BlobIndex index) const noexcept = 0;
+    virtual const void* getStoredBlobData(BlobIndex index) const noexcept = 0;
+
+    // Whether the archive stores a checksum for each blob. Version 1 archives
+    // do not.
+    virtual bool hasChecksums() const noexcept = 0;
+
+    // Checks the blob's stored bytes against its checksum. Always succeeds if
+    // the archive has no checksums.
+    virtual bool verifyBlob(BlobIndex index) const noexcept = 0;
+
+    // Hint that the blobs will be read soon so the OS can start paging them
+    // in from disk. Does not wait for the reads to finish.
+    virtual void prefetch(Vector<BlobIndex> indicies) noexcept = 0;
 };
 
 #endif  // SRC_PACK_PACK_READER_H_
@@ -24,52 +24,38 @@
 // IN THE SOFTWARE.
 // **********
 
+
 #include "pack/pack-writer.h"
 
-#include "os/os.h"
+#include "os/c.h"
+#include "os/condition-variable.h"
+#include "os/mutex.h"
+#include "os/output-file.h"
+#include "os/thread.h"
 #include "pack/file-type.h"
-#include "pack/pack-reader.h"
+#include "pack/pack-format.h"
+#include "util/fnv.h"
+#include "util/hashtable.h"
 #include "util/int.h"
+#include "util/jobs.h"
 #include "util/noexcept.h"
+#include "util/optional.h"
 #include "util/sort.h"
 #include "util/string.h"
 #include "util/vector.h"
-
-//                                       "T   s    u    n    a   g    a   r"
-static constexpr uint8_t PACK_MAGIC[8] = {84, 115, 117, 110, 97, 103, 97, 114};
-
-static constexpr uint8_t PACK_VERSION = 1;
-
-struct HeaderBlock {
-    uint8_t magic[8];
-    uint8_t version;
-    uint8_t unused[7];
-    uint32_t blobCount;
-    uint32_t pathOffsetsBlockOffset;
-    uint32_t pathsBlockOffset;
-    uint32_t pathsBlockSize;
-    uint32_t metadataBlockOffset;
-    uint32_t dataOffsetsBlockOffset;
-};
-
-typedef uint32_t PathOffset;
-
-enum BlobCompressionType { BLOB_COMPRESSION_NONE };
-
-struct BlobMetadata {
-    PackReader::BlobSize uncompressedSize;
-    PackReader::BlobSize compressedSize;
-    BlobCompressionType compressionType;
-};
+#include "util/xxhash.h"
 
 struct Blob {
+    uint32_t rank;  // Position in the path order, or UINT32_MAX if absent.
     String path;
-    PackWriter::BlobSize size;
-    const void* data;
 };
 
 static bool
 operator<(const Blob& a, const Blob& b) noexcept {
+    if (a.rank != b.rank) {
+        return a.rank < b.rank;
+    }
+
     FileType typeA = determineFileType(a.path);
     FileType typeB = determineFileType(b.path);
     if (typeA < typeB) {
@@ -86,13 +72,21 @@ operator<(const Blob& a, const Blob& b) noexcept {
 
 class PackWriterImpl : public PackWriter {
  public:
-    bool writeToFile(StringView path) noexcept;
+    void setPageAlignMedia(bool align) noexcept;
+    void setPathOrder(Vector<StringView> paths) noexcept;
+
+    void addBlob(String path) noexcept;
 
-    void addBlob(String path, BlobSize size, const void* data) noexcept;
+    bool writeToFile(StringView path, BlobLoader load) noexcept;
+
+ private:
+    uint32_t rankOf(StringView path) noexcept;
 
  private:
     Vector<Blob> blobs;
     bool sorted = true;
+    bool pageAlignMedia = false;
+    Hashmap<String, uint32_t> pathRanks;
 };
 
 Unique<PackWriter>
@@ -100,123 +94,337 @@ PackWriter::make() noexcept {
     return Unique<PackWriter>(new PackWriterImpl);
 }
 
-bool
-PackWriterImpl::writeToFile(StringView path) noexcept {
-    uint32_t blobCount = static_cast<uint32_t>(blobs.size());
+static uint64_t
+align8(uint64_t offset) noexcept {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+static uint64_t
+alignPage(uint64_t offset) noexcept {
+    return (offset + PACK_PAGE_SIZE - 1) & ~(PACK_PAGE_SIZE - 1);
+}
+
+// Source of padding between blobs and blocks.
+static const char zeroPage[PACK_PAGE_SIZE] = {};
+
+// Smallest power of two that keeps the table at most half full.
+static uint32_t
+lookupBucketCountFor(uint32_t blobCount) noexcept {
+    uint32_t count = 1;
+    while (count < blobCount * 2) {
+        count *= 2;
+    }
+    return count;
+}
 
-    // Sort blobs by size (smallest first).
+// Write `size` zero bytes, where `size` is less than a page.
+static bool
+writePadding(OutputFile& file, uint64_t size) noexcept {
+    return size == 0 || file.write(zeroPage, static_cast<size_t>(size));
+}
+
+// Whether the `size` bytes written at `offset` are the same as `data`.
+static bool
+sameAsWritten(OutputFile& file,
+              uint64_t offset,
+              const void* data,
+              uint64_t size) noexcept {
+    char buffer[16 * PACK_PAGE_SIZE];
+    const char* expected = static_cast<const char*>(data);
+
+    while (size > 0) {
+        size_t chunk = size < sizeof(buffer) ? static_cast<size_t>(size)
+                                             : sizeof(buffer);
+        if (!file.read(offset, buffer, chunk) ||
+            memcmp(buffer, expected, chunk) != 0) {
+            return false;
+        }
+        offset += chunk;
+        expected += chunk;
+        size -= chunk;
+    }
+
+    return true;
+}
+
+bool
+PackWriterImpl::writeToFile(StringView path, BlobLoader load) noexcept {
+    // Sort blobs by path order, then file type, then path.
     if (!sorted) {
         sorted = true;
         pdqsort(blobs.begin(), blobs.end());
     }
 
-    // Determine block offsets.
-    uint32_t pathOffsetsBlockSize = (blobCount + 1) * sizeof(PathOffset);
-    uint32_t pathsBlockSize = 0;
-    uint32_t metadataBlockSize = blobCount * sizeof(BlobMetadata);
-    uint32_t dataOffsetsBlockSize = blobCount * sizeof(uint32_t);
+    Optional<OutputFile> file_ = OutputFile::create(path);
+    if (!file_) {
+        return false;
+    }
+    OutputFile& file = *file_;
+
+    // Leave room for the header. We fill it in at the end, once we know where
+    // the index blocks are.
+    HeaderBlock64 headerBlock = {};
 
-    for (auto& blob : blobs) {
-        pathsBlockSize += static_cast<uint32_t>(blob.path.size());
+    if (!file.write(&headerBlock, sizeof(headerBlock))) {
+        return false;
     }
 
-    // Construct blocks.
-    HeaderBlock headerBlock = {
-            {PACK_MAGIC[0],
-             PACK_MAGIC[1],
-             PACK_MAGIC[2],
-             PACK_MAGIC[3],
-             PACK_MAGIC[4],
-             PACK_MAGIC[5],
-             PACK_MAGIC[6],
-             PACK_MAGIC[7]},
+    uint64_t offset = sizeof(headerBlock);
 
-            PACK_VERSION,
-            {0, 0, 0, 0, 0, 0, 0},
+    // Blobs that made it into the archive, as indices into `blobs`.
+    Vector<uint32_t> written;
+    Vector<BlobMetadata64> metadatasBlock;
+    Vector<uint64_t> dataOffsetsBlock;
 
-            // blobCount
-            static_cast<uint32_t>(blobCount),
+    written.reserve(blobs.size());
+    metadatasBlock.reserve(blobs.size());
+    dataOffsetsBlock.reserve(blobs.size());
 
-            // We write blocks contiguously (well, so far we do).
+    // Blobs with the same stored bytes share one copy of the data. Maps a
+    // hash of the stored bytes to the first blob written with it, as an index
+    // into `written`. Blobs whose hashes match are compared byte for byte
+    // against what was written before they share it.
+    Hashmap<uint64_t, uint32_t> firstWithHash;
 
-            // pathOffsetsBlockOffset
-            sizeof(HeaderBlock),
-            // pathsBlockOffset
-            static_cast<uint32_t>(sizeof(HeaderBlock)) + pathOffsetsBlockSize,
-            // pathsBlockSize
-            pathsBlockSize,
-            // metadataBlockOffset
-            static_cast<uint32_t>(sizeof(HeaderBlock)) + pathOffsetsBlockSize +
-                    pathsBlockSize,
-            // dataOffsetsBlockOffset
-            static_cast<uint32_t>(sizeof(HeaderBlock)) + pathOffsetsBlockSize +
-                    pathsBlockSize + metadataBlockSize,
-    };
+    // Load a window of blobs in parallel, then write them out in order and
+    // drop them. Memory use depends on the window size, not the archive size.
+    size_t windowSize = 4 * Thread::hardware_concurrency();
+    if (windowSize == 0) {
+        windowSize = 1;
+    }
+
+    // Count the window's jobs down ourselves rather than flushing the job
+    // queue after each one, which would stop and restart the workers.
+    Mutex windowMutex;
+    ConditionVariable windowLoaded;
+    size_t loading = 0;
+
+    for (size_t begin = 0; begin < blobs.size(); begin += windowSize) {
+        size_t end = begin + windowSize < blobs.size() ? begin + windowSize
+                                                       : blobs.size();
+
+        Vector<BlobData> datas;
+        Vector<bool> loaded;
+        Vector<uint64_t> hashes;
+
+        datas.resize(end - begin);
+        loaded.resize(end - begin);
+        hashes.resize(end - begin);
+
+        loading = end - begin;
+
+        // Hash in the jobs too, while the data is still in cache.
+        for (size_t i = begin; i < end; i++) {
+            JobsEnqueue([&, i] {
+                BlobData& data = datas[i - begin];
+                loaded[i - begin] = load(blobs[i].path, data);
+                if (loaded[i - begin]) {
+                    hashes[i - begin] = xxHash64(
+                            data.data, static_cast<size_t>(data.size), 0);
+                }
+
+                LockGuard lock(windowMutex);
+                loading -= 1;
+                if (loading == 0) {
+                    windowLoaded.notifyOne();
+                }
+            });
+        }
+
+        {
+            LockGuard lock(windowMutex);
+            while (loading > 0) {
+                windowLoaded.wait(lock);
+            }
+        }
+
+        for (size_t i = begin; i < end; i++) {
+            if (!loaded[i - begin]) {
+                continue;
+            }
+
+            BlobData& data = datas[i - begin];
+            uint64_t hash = hashes[i - begin];
+
+            BlobMetadata64 metadata = {
+                    data.uncompressedSize,
+                    data.size,
+                    data.compressed ? BLOB_COMPRESSION_LZ4
+                                    : BLOB_COMPRESSION_NONE,
+                    static_cast<uint32_t>(hash)};
+
+            // Point duplicates at the data we already wrote for them.
+            Optional<uint32_t*> original = firstWithHash.tryAt(hash);
+            if (original) {
+                const BlobMetadata64& other = metadatasBlock[**original];
+                if (other.uncompressedSize == metadata.uncompressedSize &&
+                    other.compressedSize == metadata.compressedSize &&
+                    other.compressionType == metadata.compressionType &&
+                    sameAsWritten(file,
+                                  dataOffsetsBlock[**original],
+                                  data.data,
+                                  data.size)) {
+                    uint64_t dataOffset = dataOffsetsBlock[**original];
+                    written.push_back(static_cast<uint32_t>(i));
+                    metadatasBlock.push_back(metadata);
+                    dataOffsetsBlock.push_back(dataOffset);
+                    continue;
+                }
+            }
+            else {
+                firstWithHash[hash] = static_cast<uint32_t>(written.size());
+            }
+
+            if (pageAlignMedia && determineFileType(blobs[i].path) == FT_MEDIA) {
+                uint64_t paddingSize = alignPage(offset) - offset;
+                if (!writePadding(file, paddingSize)) {
+                    return false;
+                }
+                offset += paddingSize;
+            }
+
+            if (!file.write(data.data, static_cast<size_t>(data.size))) {
+                return false;
+            }
+
+            written.push_back(static_cast<uint32_t>(i));
+            metadatasBlock.push_back(metadata);
+            dataOffsetsBlock.push_back(offset);
+
+            offset += data.size;
+        }
+    }
+
+    uint32_t blobCount = static_cast<uint32_t>(written.size());
 
-    Vector<PathOffset> pathOffsetsBlock;
+    // Build the index blocks.
+    uint32_t lookupBucketCount = lookupBucketCountFor(blobCount);
+
+    Vector<PathOffset64> pathOffsetsBlock;
     String pathsBlock;
-    Vector<BlobMetadata> metadatasBlock;
-    Vector<uint32_t> dataOffsetsBlock;
+    Vector<LookupBucket> lookupBlock;
 
     pathOffsetsBlock.reserve(blobCount + 1);
-    pathsBlock.reserve(pathsBlockSize);
-    metadatasBlock.reserve(blobCount);
+    lookupBlock.reserve(lookupBucketCount);
 
-    PathOffset pathOffset = 0;
-    for (auto& blob : blobs) {
+    PathOffset64 pathOffset = 0;
+    for (uint32_t i : written) {
         pathOffsetsBlock.push_back(pathOffset);
-        pathOffset += static_cast<uint32_t>(blob.path.size());
+        pathOffset += blobs[i].path.size();
     }
     pathOffsetsBlock.push_back(pathOffset);
 
-    for (auto& blob : blobs) {
-        pathsBlock << blob.path;
+    for (uint32_t i : written) {
+        pathsBlock << blobs[i].path;
     }
 
-    for (auto& blob : blobs) {
-        BlobMetadata metadata = {blob.size, blob.size, BLOB_COMPRESSION_NONE};
-        metadatasBlock.push_back(metadata);
+    for (uint32_t i = 0; i < lookupBucketCount; i++) {
+        lookupBlock.push_back({0, LOOKUP_EMPTY});
     }
 
-    // Blob data starts immediately after the data offset block.
-    uint32_t dataOffset =
-            headerBlock.dataOffsetsBlockOffset + dataOffsetsBlockSize;
-    for (auto& blob : blobs) {
-        dataOffsetsBlock.push_back(dataOffset);
-        dataOffset += blob.size;
+    uint32_t mask = lookupBucketCount - 1;
+    for (uint32_t i = 0; i < blobCount; i++) {
+        String& blobPath = blobs[written[i]].path;
+        uint32_t hash = fnvHash32(blobPath.data(), blobPath.size());
+
+        uint32_t bucket = hash & mask;
+        while (lookupBlock[bucket].blobIndex != LOOKUP_EMPTY) {
+            bucket = (bucket + 1) & mask;
+        }
+        lookupBlock[bucket] = {hash, i};
     }
 
-    // Build IO vector.
-    Vector<uint32_t> writeLengths;
-    Vector<void*> writeDatas;
+    // Determine block sizes and offsets. The index blocks follow the blob
+    // data, aligned to 8 bytes except for the paths.
+    uint64_t pathOffsetsBlockSize = (blobCount + 1) * sizeof(PathOffset64);
+    uint64_t pathsBlockSize = pathsBlock.size();
+    uint64_t metadataBlockSize = blobCount * sizeof(BlobMetadata64);
+    uint64_t dataOffsetsBlockSize = blobCount * sizeof(uint64_t);
+    uint64_t lookupBlockSize = lookupBucketCount * sizeof(LookupBucket);
+
+    uint64_t dataPaddingSize = align8(offset) - offset;
+    uint64_t pathOffsetsBlockOffset = offset + dataPaddingSize;
+    uint64_t pathsBlockOffset = pathOffsetsBlockOffset + pathOffsetsBlockSize;
+    uint64_t pathsPaddingSize =
+            align8(pathsBlockOffset + pathsBlockSize) -
+            (pathsBlockOffset + pathsBlockSize);
+    uint64_t metadataBlockOffset =
+            pathsBlockOffset + pathsBlockSize + pathsPaddingSize;
+    uint64_t dataOffsetsBlockOffset = metadataBlockOffset + metadataBlockSize;
+    uint64_t lookupBlockOffset = dataOffsetsBlockOffset + dataOffsetsBlockSize;
+
+    // Write the index blocks.
+    if (!writePadding(file, dataPaddingSize) ||
+        !file.write(pathOffsetsBlock.data(),
+                    static_cast<size_t>(pathOffsetsBlockSize)) ||
+        !file.write(pathsBlock.data(), static_cast<size_t>(pathsBlockSize)) ||
+        !writePadding(file, pathsPaddingSize) ||
+        !file.write(metadatasBlock.data(),
+                    static_cast<size_t>(metadataBlockSize)) ||
+        !file.write(dataOffsetsBlock.data(),
+                    static_cast<size_t>(dataOffsetsBlockSize)) ||
+        !file.write(lookupBlock.data(),
+                    static_cast<size_t>(lookupBlockSize))) {
+        return false;
+    }
+
+    // Go back and write the header.
+    headerBlock = {
+            {PACK_MAGIC[0],
+             PACK_MAGIC[1],
+             PACK_MAGIC[2],
+             PACK_MAGIC[3],
+             PACK_MAGIC[4],
+             PACK_MAGIC[5],
+             PACK_MAGIC[6],
+             PACK_MAGIC[7]},
+
+            PACK_VERSION,
+            {0, 0, 0, 0, 0, 0, 0},
+
+            blobCount,
+            lookupBucketCount,
+            pathOffsetsBlockOffset,
+            pathsBlockOffset,
+            pathsBlockSize,
+            metadataBlockOffset,
+            dataOffsetsBlockOffset,
+            lookupBlockOffset,
+    };
 
-    writeLengths.reserve(5 + blobCount);
-    writeDatas.reserve(5 + blobCount);
+    return file.seek(0) && file.write(&headerBlock, sizeof(headerBlock));
+}
 
-    writeLengths.push_back(static_cast<uint32_t>(sizeof(headerBlock)));
-    writeLengths.push_back(pathOffsetsBlockSize);
-    writeLengths.push_back(pathsBlockSize);
-    writeLengths.push_back(metadataBlockSize);
-    writeLengths.push_back(dataOffsetsBlockSize);
+void
+PackWriterImpl::setPageAlignMedia(bool align) noexcept {
+    pageAlignMedia = align;
+}
 
-    writeDatas.push_back(&headerBlock);
-    writeDatas.push_back(pathOffsetsBlock.data());
-    writeDatas.push_back(const_cast<char*>(pathsBlock.data()));
-    writeDatas.push_back(metadatasBlock.data());
-    writeDatas.push_back(dataOffsetsBlock.data());
+void
+PackWriterImpl::setPathOrder(Vector<StringView> paths) noexcept {
+    pathRanks.clear();
+    for (uint32_t i = 0; i < paths.size(); i++) {
+        // Keep the first occurrence.
+        if (!pathRanks.contains(paths[i])) {
+            pathRanks[paths[i]] = i;
+        }
+    }
 
     for (auto& blob : blobs) {
-        writeLengths.push_back(blob.size);
-        writeDatas.push_back(const_cast<void*>(blob.data));
+        blob.rank = rankOf(blob.path);
     }
+    sorted = false;
+}
 
-    // Write file.
-    return writeFileVec(
-            path, static_cast<uint32_t>(writeLengths.size()), writeLengths.data(), writeDatas.data());
+uint32_t
+PackWriterImpl::rankOf(StringView path) noexcept {
+    Optional<uint32_t*> rank = pathRanks.tryAt(path);
+    return rank ? **rank : UINT32_MAX;
 }
 
 void
-PackWriterImpl::addBlob(String path, BlobSize size, const void* data) noexcept {
-    blobs.push_back({move_(path), size, data});
+PackWriterImpl::addBlob(String path) noexcept {
+    uint32_t rank = rankOf(path);
+    blobs.push_back({rank, move_(path)});
     sorted = false;
 }
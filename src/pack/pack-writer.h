@@ -27,22 +27,51 @@
 #ifndef SRC_PACK_PACK_WRITER_H_
 #define SRC_PACK_PACK_WRITER_H_
 
+#include "util/function.h"
 #include "util/int.h"
 #include "util/noexcept.h"
 #include "util/string-view.h"
 #include "util/string.h"
 #include "util/unique.h"
+#include "util/vector.h"
 
 class PackWriter {
  public:
-    typedef uint32_t BlobSize;
+    typedef uint64_t BlobSize;
+
+    // The contents of one blob, supplied while the archive is being written.
+    struct BlobData {
+        BlobSize uncompressedSize = 0;
+        BlobSize size = 0;  // Bytes at `data`.
+        bool compressed = false;  // With lz4Compress().
+        const void* data = nullptr;
+
+        // Owns `data`, unless `data` points at something that outlives the
+        // write, such as a blob in another archive.
+        String storage;
+    };
+
+    // Fill in the blob for the file at `path`. Return false to leave the file
+    // out of the archive. May be called from several threads at once.
+    typedef Function<bool(StringView path, BlobData& blob)> BlobLoader;
 
     static Unique<PackWriter> make() noexcept;
     virtual ~PackWriter() = default;
 
-    virtual bool writeToFile(StringView path) noexcept = 0;
+    // Start each image and sound on a page boundary so it shares no pages
+    // with other blobs. Costs up to a page of padding per media file.
+    virtual void setPageAlignMedia(bool align) noexcept = 0;
+
+    // Write blobs with these paths first, in this order, so that blobs read
+    // together sit together. Other blobs follow, sorted by type and path.
+    virtual void setPathOrder(Vector<StringView> paths) noexcept = 0;
+
+    // Add a file to the archive. Its data is not needed until writeToFile().
+    virtual void addBlob(String path) noexcept = 0;
 
-    virtual void addBlob(String path, BlobSize size, const void* data) noexcept = 0;
+    // Write the archive, calling `load` for each blob as its turn comes. Only
+    // a few blobs are held in memory at a time, no matter how many there are.
+    virtual bool writeToFile(StringView path, BlobLoader load) noexcept = 0;
 };
 
 #endif  // SRC_PACK_PACK_WRITER_H_
@@ -73,6 +73,11 @@ uiShowAddedFile(StringView path, size_t size) noexcept {
     scheduleMessage(String() << "Added " << path << ": " << size << " bytes\n");
 }
 
+void
+uiShowReusedFile(StringView path, uint64_t size) noexcept {
+    scheduleMessage(String() << "Kept " << path << ": " << size << " bytes\n");
+}
+
 void
 uiShowWritingArchive(StringView archivePath) noexcept {
     scheduleMessage(String() << "Writing to " << archivePath << "\n");
@@ -41,6 +41,7 @@ class UI {
 
 void uiShowSkippedMissingFile(StringView path) noexcept;
 void uiShowAddedFile(StringView path, size_t size) noexcept;
+void uiShowReusedFile(StringView path, uint64_t size) noexcept;
 void uiShowWritingArchive(StringView arhivePath) noexcept;
 void uiShowListingEntry(StringView blobPath, uint64_t blobSize) noexcept;
 void uiShowExtractingFile(StringView blobPath, uint64_t blogSize) noexcept;
@@ -0,0 +1,125 @@
+/********************************
+** Tsunagari Tile Engine       **
+** directory.cpp               **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#include "core/resources.h"
+
+#include "core/log.h"
+#include "data/data-world.h"
+#include "os/c.h"
+#include "os/os.h"
+#include "resources/provider.h"
+#include "util/int.h"
+#include "util/move.h"
+#include "util/optional.h"
+#include "util/string.h"
+#include "util/vector.h"
+
+// Serves resources straight from the files in a directory, so assets can be
+// edited without repacking. Meant for development.
+//
+// Files are read into buffers of their own rather than mapped, since a mapped
+// file that is rewritten in place can fault when read. resources.cpp caches
+// the buffers, and a file that changes is read again on its next load.
+
+// Only touched by the main thread, through changedPaths().
+static bool startedWatching = false;
+static bool watching = false;
+
+static String
+getFullPath(StringView path) noexcept {
+    return String() << DataWorld::instance().datafile << "/" << path;
+}
+
+Optional<ProvidedResource>
+provideResource(StringView path) noexcept {
+    String fullPath = getFullPath(path);
+
+    Filesize size = getFileSize(fullPath);
+    if (!size) {
+        Log::err("DirectoryResources", String() << fullPath << ": file missing");
+        return none;
+    }
+
+    // Will it fit in memory?
+    if (*size > SIZE_MAX) {
+        Log::err("DirectoryResources",
+                 String() << fullPath << ": file too large");
+        return none;
+    }
+
+    if (*size == 0) {
+        return Optional<ProvidedResource>(ProvidedResource{nullptr, 0, false});
+    }
+
+    Optional<String> contents = readFile(fullPath);
+    if (!contents) {
+        Log::err("DirectoryResources",
+                 String() << fullPath << ": could not read file");
+        return none;
+    }
+
+    char* data = static_cast<char*>(malloc(contents->size()));
+    memcpy(data, contents->data(), contents->size());
+
+    return Optional<ProvidedResource>(
+            ProvidedResource{data, contents->size(), true});
+}
+
+void
+Resources::prefetch(Vector<StringView>) noexcept {
+    // Files are read when first loaded.
+}
+
+Vector<String>
+Resources::changedPaths() noexcept {
+    // Start watching here rather than from load(), which also runs on worker
+    // threads, so that the watch is only ever used by the main thread.
+    if (!startedWatching) {
+        startedWatching = true;
+
+        StringView root = DataWorld::instance().datafile;
+        watching = watchDirectory(root);
+        if (!watching) {
+            Log::info("DirectoryResources",
+                      String() << root << ": not watching for changes");
+        }
+    }
+
+    Vector<String> paths = takeChangedFiles();
+
+    // Read changed files again the next time they are loaded. Their old
+    // contents are freed once nothing holds them.
+    for (String& path : paths) {
+        forgetResource(path);
+    }
+
+    return paths;
+}
+
+bool
+Resources::watchingForChanges() noexcept {
+    return watching;
+}
@@ -26,68 +26,272 @@
 
 #include "core/resources.h"
 
+#include <atomic>
+
+#include "core/client-conf.h"
 #include "core/log.h"
 #include "core/measure.h"
 #include "data/data-world.h"
+#include "os/c.h"
 #include "os/mutex.h"
+#include "os/os.h"
 #include "pack/pack-reader.h"
+#include "resources/provider.h"
+#include "util/hashtable.h"
 #include "util/int.h"
+#include "util/move.h"
 #include "util/unique.h"
 
-static Mutex mutex;
-static Unique<PackReader> pack;
+// An archive and where its blobs start in `verifiedBlobs`.
+struct Mount {
+    StringView path;
+    Unique<PackReader> pack;
+    size_t firstBlob;
+};
 
-static bool
-openPackFile() noexcept {
-    if (pack) {
-        return true;
-    }
+// Where a path resolves to among the mounted archives.
+struct MountedBlob {
+    uint32_t mount;
+    PackReader::BlobIndex index;
+};
+
+// The archives are opened once, under `openMutex`, and are read-only
+// afterward. Loads check `packOpened` and then read `mounts` and `blobs`
+// without locking.
+static Mutex openMutex;
+static std::atomic<bool> packOpened(false);
 
-    StringView path = DataWorld::instance().datafile;
+// The datafile followed by its patches, oldest first.
+static Vector<Mount> mounts;
 
+// Every path in every archive, resolved to the newest archive that has it.
+// Only built when patches are mounted. Otherwise the datafile's own index is
+// used.
+static Hashmap<StringView, MountedBlob> blobs;
+
+// Paths already written to the resource trace. Guarded by traceMutex.
+static Mutex traceMutex;
+static Hashset<String> tracedPaths;
+
+// Blobs already checked against their checksums, with each archive's blobs
+// starting at its Mount::firstBlob. Allocated when opening the archives if
+// verification is on.
+static std::atomic<bool>* verifiedBlobs = nullptr;
+
+static bool
+mountPackFile(StringView path, size_t& blobCount) noexcept {
     // TimeMeasure m("Opened " + path);
 
-    pack = PackReader::fromFile(path);
+    Unique<PackReader> pack = PackReader::fromFile(path);
     if (!pack) {
         Log::fatal("PackResources",
                    String() << path << ": could not open archive");
         return false;
     }
 
+    size_t firstBlob = blobCount;
+    blobCount += pack->size();
+
+    mounts.push_back(Mount{path, move_(pack), firstBlob});
     return true;
 }
 
-static String
-getFullPath(StringView path) noexcept {
-    return String() << DataWorld::instance().datafile << "/" << path;
+static bool
+openPackFile() noexcept {
+    if (packOpened.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    LockGuard lock(openMutex);
+
+    if (packOpened.load(std::memory_order_relaxed)) {
+        return true;
+    }
+
+    DataWorld& world = DataWorld::instance();
+    size_t blobCount = 0;
+
+    bool ok = mountPackFile(world.datafile, blobCount);
+    for (size_t i = 0; ok && i < world.patchfiles.size(); i++) {
+        ok = mountPackFile(world.patchfiles[i], blobCount);
+    }
+    if (!ok) {
+        mounts.clear();
+        return false;
+    }
+
+    if (mounts.size() > 1) {
+        // Later archives overwrite the entries of earlier ones.
+        blobs.reserve(blobCount);
+        for (uint32_t m = 0; m < mounts.size(); m++) {
+            PackReader* pack = mounts[m].pack.get();
+            for (PackReader::BlobIndex i = 0; i < pack->size(); i++) {
+                blobs[pack->getBlobPath(i)] = MountedBlob{m, i};
+            }
+        }
+    }
+
+    if (Conf::verifyResources) {
+        // Value-initialized to false.
+        verifiedBlobs = new std::atomic<bool>[blobCount]();
+    }
+
+    packOpened.store(true, std::memory_order_release);
+    return true;
 }
 
-Optional<StringView>
-Resources::load(StringView path) noexcept {
-    LockGuard lock(mutex);
+static bool
+findBlob(StringView path, MountedBlob& blob) noexcept {
+    if (mounts.size() == 1) {
+        PackReader::BlobIndex index = mounts[0].pack->findIndex(path);
+        if (index == PackReader::BLOB_NOT_FOUND) {
+            return false;
+        }
+        blob = MountedBlob{0, index};
+        return true;
+    }
+
+    Optional<MountedBlob*> found = blobs.tryAt(path);
+    if (!found) {
+        return false;
+    }
+    blob = **found;
+    return true;
+}
+
+// Record the first load of each path so pack-tool can place blobs in the
+// order the game reads them.
+static void
+tracePath(StringView path) noexcept {
+    if (Conf::resourceTracePath.size() == 0) {
+        return;
+    }
+
+    LockGuard lock(traceMutex);
 
+    if (!tracedPaths.insert(String(path))) {
+        return;
+    }
+
+    String line = String() << path << "\n";
+    if (!appendFile(Conf::resourceTracePath, line.size(), line.data())) {
+        Log::err("PackResources",
+                 String() << Conf::resourceTracePath
+                          << ": could not write resource trace");
+    }
+}
+
+// Check each blob the first time it is loaded, so a damaged archive costs one
+// hash per blob rather than one per load, and nothing at startup. Threads that
+// load the same blob at once may both check it.
+static bool
+verifyBlob(MountedBlob blob) noexcept {
+    if (!verifiedBlobs) {
+        return true;
+    }
+
+    const Mount& mount = mounts[blob.mount];
+    std::atomic<bool>& verified = verifiedBlobs[mount.firstBlob + blob.index];
+
+    if (verified.load(std::memory_order_acquire)) {
+        return true;
+    }
+    if (!mount.pack->verifyBlob(blob.index)) {
+        return false;
+    }
+
+    verified.store(true, std::memory_order_release);
+    return true;
+}
+
+static String
+getFullPath(StringView archive, StringView path) noexcept {
+    return String() << archive << "/" << path;
+}
+
+Optional<ProvidedResource>
+provideResource(StringView path) noexcept {
     if (!openPackFile()) {
         return none;
     }
 
-    PackReader::BlobIndex index = pack->findIndex(path);
+    MountedBlob blob;
 
-    if (index == PackReader::BLOB_NOT_FOUND) {
+    if (!findBlob(path, blob)) {
         Log::err("PackResources",
-                 String() << getFullPath(path) << ": file missing");
+                 String() << getFullPath(DataWorld::instance().datafile, path)
+                          << ": file missing");
         return none;
     }
 
-    uint32_t blobSize = pack->getBlobSize(index);
+    const Mount& mount = mounts[blob.mount];
+    PackReader::BlobSize blobSize = mount.pack->getBlobSize(blob.index);
 
     // Will it fit in memory?
-    if (blobSize > UINT32_MAX) {
+    if (blobSize > SIZE_MAX) {
+        Log::err("PackResources",
+                 String() << getFullPath(mount.path, path)
+                          << ": file too large");
+        return none;
+    }
+
+    tracePath(path);
+
+    // Compressed blobs are decompressed into a buffer for the cache, which
+    // frees it once it has gone unused for a while. Others are read in place.
+    bool compressed = mount.pack->isBlobCompressed(blob.index);
+    char* buffer = nullptr;
+    if (compressed) {
+        buffer = static_cast<char*>(malloc(static_cast<size_t>(blobSize)));
+    }
+
+    const void* data = verifyBlob(blob)
+                               ? mount.pack->getBlobData(blob.index, buffer)
+                               : nullptr;
+    if (!data) {
+        free(buffer);
         Log::err("PackResources",
-                 String() << getFullPath(path) << ": file too large");
+                 String() << getFullPath(mount.path, path) << ": file corrupt");
         return none;
     }
 
-    void* data = pack->getBlobData(index);
+    return Optional<ProvidedResource>(
+            ProvidedResource{static_cast<char*>(const_cast<void*>(data)),
+                             static_cast<size_t>(blobSize),
+                             compressed});
+}
+
+void
+Resources::prefetch(Vector<StringView> paths) noexcept {
+    if (!openPackFile()) {
+        return;
+    }
+
+    // Indicies for each archive.
+    Vector<Vector<PackReader::BlobIndex>> indicies;
+    indicies.resize(mounts.size());
+
+    for (StringView path : paths) {
+        MountedBlob blob;
+        if (findBlob(path, blob)) {
+            indicies[blob.mount].push_back(blob.index);
+        }
+    }
+
+    for (size_t m = 0; m < mounts.size(); m++) {
+        if (indicies[m].size()) {
+            mounts[m].pack->prefetch(move_(indicies[m]));
+        }
+    }
+}
+
+Vector<String>
+Resources::changedPaths() noexcept {
+    // Archives don't change while the game runs.
+    return Vector<String>();
+}
 
-    return Optional<StringView>(StringView(static_cast<char*>(data), blobSize));
+bool
+Resources::watchingForChanges() noexcept {
+    return false;
 }
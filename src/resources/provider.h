@@ -1,9 +1,8 @@
-/***************************************
-** Tsunagari Tile Engine              **
-** rc-reader-cache.h                  **
-** Copyright 2011-2013 Michael Reiley **
-** Copyright 2011-2019 Paul Merrill   **
-***************************************/
+/********************************
+** Tsunagari Tile Engine       **
+** provider.h                  **
+** Copyright 2019 Paul Merrill **
+********************************/
 
 // **********
 // Permission is hereby granted, free of charge, to any person obtaining a copy
@@ -25,44 +24,33 @@
 // IN THE SOFTWARE.
 // **********
 
-#ifndef SRC_CACHE_RC_READER_CACHE_H_
-#define SRC_CACHE_RC_READER_CACHE_H_
+#ifndef SRC_RESOURCES_PROVIDER_H_
+#define SRC_RESOURCES_PROVIDER_H_
 
-#include "cache/rc-cache.h"
+#include "util/int.h"
+#include "util/noexcept.h"
+#include "util/optional.h"
 #include "util/string-view.h"
 
-template<typename T>
-using GenFn = T (*)(StringView name);
+// Between resources.cpp, which caches loaded resources, and the provider
+// built in, pack.cpp or directory.cpp, which reads them.
 
-template<typename T, GenFn<T> fn>
-class RcReaderCache {
- public:
-    T momentaryRequest(StringView name) noexcept {
-        T t = cache.momentaryRequest(name);
-        if (t) {
-            return t;
-        }
+// A resource as read by the provider.
+struct ProvidedResource {
+    char* data;
+    size_t size;
 
-        t = fn(name);
-        cache.momentaryPut(name, t);
-        return t;
-    }
-
-    T lifetimeRequest(StringView name) noexcept {
-        T t = cache.lifetimeRequest(name);
-        if (t) {
-            return t;
-        }
-
-        t = fn(name);
-        cache.lifetimePut(name, t);
-        return t;
-    }
+    // If set, `data` came from malloc() and is cached until freed. If not,
+    // the provider keeps it for as long as the program runs, like a blob
+    // stored uncompressed in a mapped archive.
+    bool owned;
+};
 
-    void garbageCollect() noexcept { cache.garbageCollect(); }
+// Read a resource. Called on any thread. Errors are logged.
+Optional<ProvidedResource> provideResource(StringView path) noexcept;
 
- private:
-    RcCache<T> cache;
-};
+// Drop a cached resource, for example because its file changed. Its data is
+// freed once nothing holds it.
+void forgetResource(StringView path) noexcept;
 
-#endif  // SRC_CACHE_RC_READER_CACHE_H_
+#endif  // SRC_RESOURCES_PROVIDER_H_
@@ -0,0 +1,166 @@
+/********************************
+** Tsunagari Tile Engine       **
+** resources.cpp               **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#include "core/resources.h"
+
+#include "cache/cache-impl.h"
+#include "os/c.h"
+#include "os/mutex.h"
+#include "resources/provider.h"
+#include "util/function.h"
+#include "util/jobs.h"
+#include "util/move.h"
+#include "util/optional.h"
+#include "util/string.h"
+
+// Resources the provider read into memory, such as blobs decompressed from an
+// archive.
+struct CachedResource {
+    char* data;
+    size_t size;
+};
+
+// Guards `cache`, which is shared by every thread that loads resources.
+static Mutex cacheMutex;
+static Cache<CachedResource> cache("Resources");
+
+Resource::Resource(StringView data, int cacheHandle) noexcept
+        : data_(data), cacheHandle(cacheHandle) {}
+
+Resource::Resource(Resource&& other) noexcept
+        : data_(other.data_), cacheHandle(other.cacheHandle) {
+    other.data_ = StringView();
+    other.cacheHandle = -1;
+}
+
+Resource::~Resource() noexcept {
+    if (cacheHandle == -1) {
+        return;
+    }
+
+    LockGuard lock(cacheMutex);
+
+    // Resources are released on worker threads too, which cannot read
+    // World::time(). The next prune stamps the time instead.
+    cache.release(cacheHandle, IN_USE_NOW);
+}
+
+Resource&
+Resource::operator=(Resource&& other) noexcept {
+    // Releases what this held once it goes out of scope.
+    Resource old(move_(*this));
+
+    data_ = other.data_;
+    cacheHandle = other.cacheHandle;
+    other.data_ = StringView();
+    other.cacheHandle = -1;
+    return *this;
+}
+
+Optional<Resource>
+Resources::load(StringView path) noexcept {
+    {
+        LockGuard lock(cacheMutex);
+
+        CacheHandle handle = cache.acquire(path);
+        if (handle) {
+            CachedResource& cached = cache[*handle];
+            return Optional<Resource>(
+                    Resource(StringView(cached.data, cached.size), *handle));
+        }
+    }
+
+    // Read without the lock so that workers can decompress in parallel.
+    Optional<ProvidedResource> provided = provideResource(path);
+    if (!provided) {
+        return none;
+    }
+
+    StringView data(provided->data, provided->size);
+
+    if (!provided->owned) {
+        return Optional<Resource>(Resource(data, -1));
+    }
+
+    LockGuard lock(cacheMutex);
+
+    // Another thread may have loaded it in the meantime.
+    if (cache.contains(path)) {
+        free(provided->data);
+
+        int handle = *cache.acquire(path);
+        CachedResource& cached = cache[handle];
+        return Optional<Resource>(
+                Resource(StringView(cached.data, cached.size), handle));
+    }
+
+    int handle = cache.set(
+            path, CachedResource{provided->data, provided->size}, data.size);
+    return Optional<Resource>(Resource(data, handle));
+}
+
+void
+forgetResource(StringView path) noexcept {
+    LockGuard lock(cacheMutex);
+    cache.erase(path);
+}
+
+static JobPriority
+jobPriorityFor(ResourceLoadPriority priority) noexcept {
+    switch (priority) {
+    case RESOURCE_LOAD_NOW:
+        return JOB_PRIORITY_HIGH;
+    case RESOURCE_LOAD_NEXT_AREA:
+        return JOB_PRIORITY_NORMAL;
+    default:
+        return JOB_PRIORITY_LOW;
+    }
+}
+
+void
+Resources::loadAsync(ResourceLoadPriority priority,
+                     StringView path,
+                     Function<void(StringView)> onLoad) noexcept {
+    String path_ = path;
+
+    JobsEnqueue(
+            [path_, onLoad] {
+                Optional<Resource> resource = load(path_);
+                if (resource && onLoad) {
+                    onLoad(resource->view());
+                }
+            },
+            jobPriorityFor(priority));
+}
+
+void
+Resources::prune(time_t latestPermissibleUse) noexcept {
+    LockGuard lock(cacheMutex);
+
+    cache.garbageCollect(latestPermissibleUse, [](CachedResource& resource) {
+        free(resource.data);
+    });
+}
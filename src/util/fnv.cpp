@@ -64,3 +64,17 @@ fnvHash(const char* data, size_t size) noexcept {
 }
 
 #endif
+
+uint32_t
+fnvHash32(const char* data, size_t size) noexcept {
+    uint32_t hash = 0x811c9dc5;
+
+    const uint8_t* begin = (const uint8_t*)data;
+    const uint8_t* end = begin + size;
+
+    while (begin < end) {
+        hash ^= (uint32_t)*begin++;
+        hash *= 0x01000193;
+    }
+    return hash;
+}
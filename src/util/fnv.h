@@ -32,4 +32,7 @@
 
 size_t fnvHash(const char* data, size_t size) noexcept;
 
+// 32-bit FNV-1a regardless of platform, for hashes that are stored in files.
+uint32_t fnvHash32(const char* data, size_t size) noexcept;
+
 #endif  // SRC_UTIL_FNV_H_
@@ -33,3 +33,8 @@ hash_(float d) noexcept {
     char* bits = reinterpret_cast<char*>(&d);
     return *reinterpret_cast<size_t*>(bits);
 }
+
+size_t
+hash_(uint64_t i) noexcept {
+    return static_cast<size_t>(i ^ (i >> 32));
+}
@@ -33,5 +33,6 @@
 template<typename T> size_t hash_(const T&) noexcept;
 
 size_t hash_(float d) noexcept;
+size_t hash_(uint64_t i) noexcept;
 
 #endif  // SRC_UTIL_HASH_H_
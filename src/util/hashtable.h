@@ -289,6 +289,7 @@ namespace hopscotch {
             if (!empty()) {
                 ::new (static_cast<void*>(&emptyBucket.mValue))
                         V(move_(value()));
+                emptyBucket.setEmpty(false);
 
                 destroyValue();
                 setEmpty(true);
@@ -604,8 +605,8 @@ class Hashmap : private hopscotch::GrowthPolicy {
         size_t ibucketForHash = bucketForHash(hash_(pos.key()));
 
         if (pos.mBucketsIterator != pos.mBucketsEndIterator) {
-            auto itBucket = mBucketsData.begin() + pos.mBucketsIterator -
-                            mBucketsData.begin();
+            auto itBucket = mBucketsData.begin() +
+                            (pos.mBucketsIterator - mBucketsData.begin());
             eraseFromBucket(*itBucket, ibucketForHash);
 
             return ++Iterator(
@@ -39,13 +39,13 @@ static size_t workerLimit = 0;
 static Vector<Thread> workers;
 static int jobsRunning = 0;
 
-// Empty jobs are the signal to quit.
-static Vector<Function<void()>> jobs;
+// One queue per JobPriority. Empty jobs are the signal to quit.
+static Vector<Function<void()>> jobs[JOB_PRIORITY_COUNT];
 
 // Whether the destructor has been called,
 static bool tearingDown = false;
 
-// Access to workers vector, jobs deque, jobsRunning, and tearingDown.
+// Access to workers vector, jobs queues, jobsRunning, and tearingDown.
 static Mutex jobsMutex;
 
 // Events for when a job is added.
@@ -54,6 +54,28 @@ static ConditionVariable jobAvailable;
 // Events for when a job is finished.
 static ConditionVariable jobsDone;
 
+static bool
+noJobs() noexcept {
+    for (auto& queue : jobs) {
+        if (!queue.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static Function<void()>
+takeJob() noexcept {
+    for (auto& queue : jobs) {
+        if (!queue.empty()) {
+            Function<void()> job = move_(queue.front());
+            queue.erase(queue.begin());
+            return job;
+        }
+    }
+    return Function<void()>();
+}
+
 static void
 work() noexcept {
     Function<void()> job;
@@ -62,12 +84,11 @@ work() noexcept {
         {
             LockGuard lock(jobsMutex);
 
-            while (jobs.empty()) {
+            while (noJobs()) {
                 jobAvailable.wait(lock);
             }
 
-            job = move_(jobs.front());
-            jobs.erase(jobs.begin());
+            job = takeJob();
 
             jobsRunning += 1;
         }
@@ -81,7 +102,7 @@ work() noexcept {
 
             jobsRunning -= 1;
 
-            if (jobsRunning == 0 && jobs.empty()) {
+            if (jobsRunning == 0 && noJobs()) {
                 jobsDone.notifyOne();
             }
         }
@@ -89,12 +110,12 @@ work() noexcept {
 }
 
 void
-JobsEnqueue(Job job) noexcept {
+JobsEnqueue(Job job, JobPriority priority) noexcept {
     LockGuard lock(jobsMutex);
 
     assert_(!tearingDown);
 
-    jobs.push_back(job);
+    jobs[priority].push_back(job);
 
     if (workerLimit == 0) {
         workerLimit = Thread::hardware_concurrency();
@@ -111,12 +132,12 @@ void
 JobsFlush() noexcept {
 	// TODO: Don't quit the threads.
 
-    // Wait for all jobs to finish.
+    // Wait for all jobs to finish. Check under the same lock the workers
+    // signal under so that a job finishing just before we wait is not missed.
     {
-        Mutex m;
-        LockGuard lock(m);
+        LockGuard lock(jobsMutex);
 
-        while (jobsRunning > 0 || jobs.size() > 0) {
+        while (jobsRunning > 0 || !noJobs()) {
             jobsDone.wait(lock);
         }
     }
@@ -127,7 +148,7 @@ JobsFlush() noexcept {
 
         for (size_t i = 0; i < workers.size(); i++) {
             // Send over empty jobs.
-            jobs.emplace_back();
+            jobs[JOB_PRIORITY_LOW].emplace_back();
         }
 
         tearingDown = true;
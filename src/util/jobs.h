@@ -32,7 +32,15 @@
 
 typedef Function<void()> Job;
 
-void JobsEnqueue(Job job) noexcept;
+// Workers always take the oldest job of the highest priority waiting.
+enum JobPriority {
+    JOB_PRIORITY_HIGH,
+    JOB_PRIORITY_NORMAL,
+    JOB_PRIORITY_LOW,
+    JOB_PRIORITY_COUNT,
+};
+
+void JobsEnqueue(Job job, JobPriority priority = JOB_PRIORITY_NORMAL) noexcept;
 void JobsFlush() noexcept;
 
 #endif  // SRC_UTIL_SCHEDULER_H_
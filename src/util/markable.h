@@ -58,6 +58,13 @@ class Markable {
     inline CONSTEXPR11 bool exists() const noexcept { return x != MarkedValue; }
     inline CONSTEXPR11 operator bool() const noexcept { return exists(); }
 
+    inline CONSTEXPR11 bool operator==(const This& other) const noexcept {
+        return x == other.x;
+    }
+    inline CONSTEXPR11 bool operator!=(const This& other) const noexcept {
+        return x != other.x;
+    }
+
     inline CONSTEXPR14 const T* operator->() const noexcept {
         assert_(exists());
         return &x;
@@ -0,0 +1,84 @@
+/********************************
+** Tsunagari Tile Engine       **
+** radix-sort.h                **
+** Copyright 2019 Paul Merrill **
+********************************/
+
+// **********
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+// **********
+
+#ifndef SRC_UTIL_RADIX_SORT_H_
+#define SRC_UTIL_RADIX_SORT_H_
+
+#include "util/int.h"
+#include "util/noexcept.h"
+
+struct RadixItem {
+    uint32_t key;
+    uint32_t value;  // Carried along, not compared.
+};
+
+// Stable least-significant-digit radix sort by key, one byte per pass.
+// Passes over bytes that are the same in every key are skipped. Does not
+// allocate: `scratch` must have room for as many items as are being sorted.
+inline void
+radixSort(RadixItem* begin, RadixItem* end, RadixItem* scratch) noexcept {
+    size_t n = static_cast<size_t>(end - begin);
+    if (n < 2) {
+        return;
+    }
+
+    RadixItem* from = begin;
+    RadixItem* to = scratch;
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        size_t counts[256] = {0};
+        for (size_t i = 0; i < n; i++) {
+            counts[(from[i].key >> shift) & 0xFF]++;
+        }
+
+        if (counts[(from[0].key >> shift) & 0xFF] == n) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t& count : counts) {
+            size_t c = count;
+            count = offset;
+            offset += c;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            to[counts[(from[i].key >> shift) & 0xFF]++] = from[i];
+        }
+
+        RadixItem* tmp = from;
+        from = to;
+        to = tmp;
+    }
+
+    if (from != begin) {
+        for (size_t i = 0; i < n; i++) {
+            begin[i] = from[i];
+        }
+    }
+}
+
+#endif  // SRC_UTIL_RADIX_SORT_H_
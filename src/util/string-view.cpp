@@ -66,9 +66,9 @@ StringView::rfind(char needle) const noexcept {
     if (size == 0) {
         return mark;
     }
-    for (size_t i = size - 1; i >= 0; i--) {
-        if (data[i] == needle) {
-            return StringPosition(i);
+    for (size_t i = size; i > 0; i--) {
+        if (data[i - 1] == needle) {
+            return StringPosition(i - 1);
         }
     }
     return mark;
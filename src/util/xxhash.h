@@ -1,9 +1,8 @@
-/***************************************
-** Tsunagari Tile Engine              **
-** rc-cache.h                         **
-** Copyright 2011-2013 Michael Reiley **
-** Copyright 2011-2019 Paul Merrill   **
-***************************************/
+/********************************
+** Tsunagari Tile Engine       **
+** xxhash.h                    **
+** Copyright 2019 Paul Merrill **
+********************************/
 
 // **********
 // Permission is hereby granted, free of charge, to any person obtaining a copy
@@ -25,33 +24,14 @@
 // IN THE SOFTWARE.
 // **********
 
-#ifndef SRC_CACHE_RC_CACHE_H_
-#define SRC_CACHE_RC_CACHE_H_
+#ifndef SRC_UTIL_XXHASH_H_
+#define SRC_UTIL_XXHASH_H_
 
-#include "util/hashtable.h"
-#include "util/string-view.h"
-#include "util/string.h"
+#include "util/int.h"
+#include "util/noexcept.h"
 
-template<typename T>
-class RcCache {
- public:
-    T momentaryRequest(StringView name) noexcept;
+// XXH64 by Yann Collet. Fast, non-cryptographic, and the same on every
+// platform, so it can be stored in files.
+uint64_t xxHash64(const void* data, size_t size, uint64_t seed) noexcept;
 
-    T lifetimeRequest(StringView name) noexcept;
-
-    void momentaryPut(StringView name, T data) noexcept;
-
-    void lifetimePut(StringView name, T data) noexcept;
-
-    void garbageCollect() noexcept;
-
- private:
-    struct CacheEntry {
-        T data;
-        time_t lastUsed = 0;  // time in milliseconds
-    };
-
-    Hashmap<String, CacheEntry> map;
-};
-
-#endif  // SRC_CORE_RC_CACHE_H_
+#endif  // SRC_UTIL_XXHASH_H_